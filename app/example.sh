@@ -1,10 +1,9 @@
 #/bin/bash
 
 # Config
-poll_count=100
+sample_count=500
 
 sysfs_dir="/sys/class/bc_project/inclinometer/attr"
-scan_mode=5
 
 
 # Error codes
@@ -18,49 +17,29 @@ if [ ! -d "${sysfs_dir}" ]; then
 	exit ${E_SYSFS_NO_DIR}
 fi
 
-if [ ! -f "${sysfs_dir}/mode" ]; then
-	echo "Cannot find sysfs attribute: ${sysfs_dir}/mode"
+if [ ! -f "${sysfs_dir}/calibrate" ]; then
+	echo "Cannot find sysfs attribute: ${sysfs_dir}/calibrate"
 	exit ${E_SYSFS_NO_ATTR}
 fi
 
-if [ ! -w "${sysfs_dir}/mode" ]; then
+if [ ! -w "${sysfs_dir}/calibrate" ]; then
 	echo "You must have permission to write in sysfs"
 	exit ${E_SYSFS_NO_PERM}
 fi
 
 
 scan() {
-	mode=$(cat ${sysfs_dir}/mode)
-	echo $scan_mode > "${sysfs_dir}/mode"
+	echo $sample_count > "${sysfs_dir}/calibrate" || return
 
 	echo
 	echo "Scanning..."
 
-	for i in $(seq 1 $poll_count); do
-
-		ax=$((ax + $(cat ${sysfs_dir}/accel_x)))
-		ay=$((ay + $(cat ${sysfs_dir}/accel_y)))
-		az=$((az + $(cat ${sysfs_dir}/accel_z)))
-
-		gx=$((gx + $(cat ${sysfs_dir}/gyro_x)))
-		gy=$((gy + $(cat ${sysfs_dir}/gyro_y)))
-		gz=$((gz + $(cat ${sysfs_dir}/gyro_z)))
-
+	while grep -q "running" "${sysfs_dir}/calibrate"; do
+		sleep 0.2
 	done
 
-	echo ${mode} > "${sysfs_dir}/mode"
-
 	echo
-	echo "The resulting average values are:"
-
-	printf "Accel X: %6d   Gyro X: %6d\n" \
-		$((ax / poll_count)) $((gx / poll_count))
-	printf "Accel Y: %6d   Gyro Y: %6d\n" \
-		$((ay / poll_count)) $((gy / poll_count))
-	printf "Accel Z: %6d   Gyro Z: %6d\n" \
-		$((az / poll_count)) $((gz / poll_count))
-
-	unset -v ax ay az gx gy gz
+	cat "${sysfs_dir}/calibrate"
 }
 
 echo
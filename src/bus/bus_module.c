@@ -0,0 +1,281 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/kernel.h>
+#include <linux/spinlock.h>
+#include <linux/wait.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+
+#include "bus_module.h"
+
+#define MP KBUILD_MODNAME ": "		/* Log Message Prefix */
+
+/*
+ * Arbitration of the I2C bus shared by the sensor and the display.
+ * Every transfer is wrapped in bc_bus_get()/bc_bus_put(); a waiting sensor
+ * transfer always goes before a waiting display one. The display splits
+ * its payloads into chunk_size transfers, so a sensor transfer never waits
+ * longer than one display chunk. Display bus time is limited to
+ * display_budget percent, frames started over the budget are shed.
+ */
+
+#define DEFAULT_CHUNK_SIZE	32	/* Bytes, ~0.8 ms at 400 kHz */
+#define DEFAULT_DISPLAY_BUDGET	50	/* Percent of bus time */
+#define DEFAULT_BUS_KHZ		400
+#define BUDGET_WINDOW_MS	200	/* Token bucket depth */
+#define BUS_XFER_OVERHEAD	2	/* Address and register/control byte */
+#define BUS_BYTE_BITS		9	/* 8 bits and ACK */
+
+static unsigned int chunk_size = DEFAULT_CHUNK_SIZE;
+module_param(chunk_size, uint, 0644);
+MODULE_PARM_DESC(chunk_size, "Largest display transfer payload, bytes");
+
+static unsigned int display_budget = DEFAULT_DISPLAY_BUDGET;
+module_param(display_budget, uint, 0644);
+MODULE_PARM_DESC(display_budget,
+		 "Bus time share of the display, percent (100 - unlimited)");
+
+static unsigned int bus_khz = DEFAULT_BUS_KHZ;
+module_param(bus_khz, uint, 0644);
+MODULE_PARM_DESC(bus_khz, "Bus clock, kHz (sensor wait bound estimate)");
+
+struct bus_stats {
+	u64 xfers;
+	u64 bytes;
+	u64 busy_ns;
+	u64 wait_ns;
+	u32 max_wait_us;
+	u32 frames;			/* Admitted */
+	u32 shed;			/* Over the budget */
+};
+
+static DEFINE_SPINLOCK(bus_lock);	/* Protects everything below */
+static DECLARE_WAIT_QUEUE_HEAD(bus_wait);
+static bool bus_busy;
+static ktime_t bus_since;		/* Current owner got the bus */
+static int bus_waiting[BC_BUS_PRIO_COUNT];
+static struct bus_stats stats[BC_BUS_PRIO_COUNT];
+
+/* Display bus time left, ns; may go negative, frames wait for refill */
+static s64 tokens;
+static ktime_t tokens_time;
+
+static struct dentry *debugfs_dir;
+
+static bool bus_try_get(enum bc_bus_prio prio)
+{
+	int p;
+	bool ret;
+
+	spin_lock(&bus_lock);
+
+	ret = !bus_busy;
+	for (p = 0; ret && p < prio; p++)
+		if (bus_waiting[p])
+			ret = false;
+
+	if (ret) {
+		bus_busy = true;
+		bus_waiting[prio]--;
+		bus_since = ktime_get();
+	}
+
+	spin_unlock(&bus_lock);
+
+	return ret;
+}
+
+/**
+ * bc_bus_get() - wait for the bus
+ * @prio: client
+ *
+ * Must be paired with bc_bus_put(). May sleep.
+ */
+void bc_bus_get(enum bc_bus_prio prio)
+{
+	ktime_t start = ktime_get();
+	s64 wait;
+
+	spin_lock(&bus_lock);
+	bus_waiting[prio]++;
+	spin_unlock(&bus_lock);
+
+	wait_event(bus_wait, bus_try_get(prio));
+
+	wait = ktime_to_ns(ktime_sub(bus_since, start));
+
+	spin_lock(&bus_lock);
+	stats[prio].wait_ns += wait;
+	stats[prio].max_wait_us = max_t(u32, stats[prio].max_wait_us,
+					div_s64(wait, NSEC_PER_USEC));
+	spin_unlock(&bus_lock);
+}
+EXPORT_SYMBOL(bc_bus_get);
+
+/**
+ * bc_bus_put() - release the bus
+ * @prio: client
+ * @bytes: payload transferred
+ */
+void bc_bus_put(enum bc_bus_prio prio, unsigned int bytes)
+{
+	s64 busy;
+
+	spin_lock(&bus_lock);
+
+	busy = ktime_to_ns(ktime_sub(ktime_get(), bus_since));
+	stats[prio].xfers++;
+	stats[prio].bytes += bytes;
+	stats[prio].busy_ns += busy;
+	if (prio == BC_BUS_DISPLAY)
+		tokens -= busy;
+	bus_busy = false;
+
+	spin_unlock(&bus_lock);
+
+	wake_up_all(&bus_wait);
+}
+EXPORT_SYMBOL(bc_bus_put);
+
+/**
+ * bc_bus_admit() - decide whether a new frame fits into the budget
+ * @prio: client
+ *
+ * Only the display has a budget, a frame is admitted while it has bus
+ * time left, it may overdraw it.
+ *
+ * Return: true if the frame is to be sent, false if it's to be shed.
+ */
+bool bc_bus_admit(enum bc_bus_prio prio)
+{
+	bool ret = true;
+	unsigned int budget = min(READ_ONCE(display_budget), 100U);
+	s64 depth = (s64)BUDGET_WINDOW_MS * NSEC_PER_MSEC * budget / 100;
+	ktime_t now = ktime_get();
+
+	if (prio != BC_BUS_DISPLAY)
+		return true;
+
+	spin_lock(&bus_lock);
+
+	tokens += div_s64(ktime_to_ns(ktime_sub(now, tokens_time)) * budget,
+			  100);
+	tokens = min(tokens, depth);
+	tokens_time = now;
+
+	if (budget < 100 && tokens <= 0)
+		ret = false;
+
+	if (ret)
+		stats[prio].frames++;
+	else
+		stats[prio].shed++;
+
+	spin_unlock(&bus_lock);
+
+	return ret;
+}
+EXPORT_SYMBOL(bc_bus_admit);
+
+/**
+ * bc_bus_chunk_size() - largest display payload of a single transfer
+ *
+ * Return: chunk size in bytes, 1 to BC_BUS_MAX_CHUNK.
+ */
+unsigned int bc_bus_chunk_size(void)
+{
+	return clamp(READ_ONCE(chunk_size), 1U, (unsigned int)BC_BUS_MAX_CHUNK);
+}
+EXPORT_SYMBOL(bc_bus_chunk_size);
+
+
+#pragma region /* Debugfs */
+static const char * const prio_names[BC_BUS_PRIO_COUNT] = {
+	[BC_BUS_SENSOR] = "sensor",
+	[BC_BUS_DISPLAY] = "display",
+};
+
+static int stats_show(struct seq_file *m, void *v)
+{
+	int p;
+	struct bus_stats snap[BC_BUS_PRIO_COUNT];
+	unsigned int khz = max(READ_ONCE(bus_khz), 1U);
+
+	spin_lock(&bus_lock);
+	memcpy(snap, stats, sizeof(snap));
+	spin_unlock(&bus_lock);
+
+	for (p = 0; p < BC_BUS_PRIO_COUNT; p++)
+		seq_printf(m, "%-8s xfers %llu bytes %llu busy_us %llu wait_us %llu max_wait_us %u frames %u shed %u\n",
+			   prio_names[p], snap[p].xfers, snap[p].bytes,
+			   div_u64(snap[p].busy_ns, NSEC_PER_USEC),
+			   div_u64(snap[p].wait_ns, NSEC_PER_USEC),
+			   snap[p].max_wait_us, snap[p].frames, snap[p].shed);
+
+	/* One display chunk in flight, on the wire only */
+	seq_printf(m, "sensor_wait_bound_us %u\n",
+		   (bc_bus_chunk_size() + BUS_XFER_OVERHEAD) * BUS_BYTE_BITS *
+		   USEC_PER_MSEC / khz);
+
+	return 0;
+}
+
+static int stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, stats_show, inode->i_private);
+}
+
+/* Any write resets the counters */
+static ssize_t stats_write(struct file *file, const char __user *buf,
+			   size_t count, loff_t *ppos)
+{
+	spin_lock(&bus_lock);
+	memset(stats, 0, sizeof(stats));
+	spin_unlock(&bus_lock);
+
+	return count;
+}
+
+static const struct file_operations stats_fops = {
+	.owner = THIS_MODULE,
+	.open = stats_open,
+	.read = seq_read,
+	.write = stats_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+#pragma endregion
+
+
+static int __init bus_mod_init(void)
+{
+	pr_info(MP "initialization...\n");
+
+	tokens_time = ktime_get();
+
+	debugfs_dir = debugfs_create_dir("bc_bus", NULL);
+	debugfs_create_file("stats", 0644, debugfs_dir, NULL, &stats_fops);
+
+	pr_info(MP "chunk %u bytes, display budget %u%%\n",
+		bc_bus_chunk_size(), display_budget);
+
+	return 0;
+}
+
+static void __exit bus_mod_exit(void)
+{
+	debugfs_remove_recursive(debugfs_dir);
+	pr_info(MP "module removed\n");
+}
+
+module_init(bus_mod_init);
+module_exit(bus_mod_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Linux Kernel Bootcamp Project: Shared Bus Module");
+MODULE_AUTHOR("Vlad Degtyarov <deesyync@gmail.com>");
+MODULE_VERSION("0.1");
@@ -0,0 +1,22 @@
+/* SPDX-License-Identifier: GPL */
+
+#ifndef __BUS_MODULE_H__
+#define __BUS_MODULE_H__
+
+#include <linux/types.h>
+
+/* Bus clients, a lower value takes the bus first */
+enum bc_bus_prio {
+	BC_BUS_SENSOR,
+	BC_BUS_DISPLAY,
+	BC_BUS_PRIO_COUNT,
+};
+
+#define BC_BUS_MAX_CHUNK	128	/* Bytes, upper limit of chunk_size */
+
+extern void bc_bus_get(enum bc_bus_prio prio);
+extern void bc_bus_put(enum bc_bus_prio prio, unsigned int bytes);
+extern bool bc_bus_admit(enum bc_bus_prio prio);
+extern unsigned int bc_bus_chunk_size(void);
+
+#endif /* __BUS_MODULE_H__ */
@@ -0,0 +1,866 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/device.h>
+#include <linux/types.h>
+#include <linux/err.h>
+#include <linux/delay.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <linux/pm_runtime.h>
+#include <linux/platform_device.h>
+#include <linux/atomic.h>
+
+#include "display_module.h"
+#include "display_fonts.h"
+#include "ssd1306_bus.h"
+#include "bus/bus_module.h"
+
+#define CREATE_TRACE_POINTS
+#include "display_trace.h"
+
+#define MP KBUILD_MODNAME ": "		/* Log Message Prefix */
+
+#define I2C_BUS 1			/* I2C bus number */
+#define I2C_DEVICE_NAME "bc-ssd1306"	/* Our device driver name */
+#define EMU_DEVICE_NAME "bc-ssd1306-emu"
+
+#define DEFAULT_AUTOSUSPEND_MS	1000	/* No drawing time before blanking */
+
+static int autosuspend_ms = DEFAULT_AUTOSUSPEND_MS;
+module_param(autosuspend_ms, int, 0444);
+MODULE_PARM_DESC(autosuspend_ms,
+		 "Time without drawing before the panel is blanked, ms");
+
+static bool emu;
+module_param(emu, bool, 0444);
+MODULE_PARM_DESC(emu, "Draw into the emulated panel instead of the I2C one");
+
+struct i2c_client *ssd1306_client;
+static struct platform_device *emu_pdev;
+
+/* Bound device and its transfer backend */
+static struct device *ssd1306_dev;
+static const struct ssd1306_bus *bus;
+
+/* Frame state, drawing is done by the logic work loop only */
+static bool frame_sent;			/* Drawing data reached the panel */
+static enum {
+	FRAME_OPEN,			/* Decided on the first drawing call */
+	FRAME_ADMITTED,
+	FRAME_SHED,
+} frame;
+
+/*
+ * GDDRAM as written by this driver, horizontal addressing fills the
+ * column window page by page. Lets bc_display_image() send only the pages
+ * that differ. Unknown until the first clear and after a failed transfer.
+ */
+static u8 shadow[SSD1306_PAGES][SSD1306_SEGMENTS];
+static atomic_t setups = ATOMIC_INIT(0);	/* GDDRAM cleared by setup */
+static bool shadow_valid;
+static struct {
+	u8 x0, x1, p0, p1;		/* Column and page window */
+	u8 x, p;			/* Next byte goes here */
+} shadow_pos;
+
+/* Data stream buffer of the bulk transfers */
+static u8 data_buf[DISPLAY_IMAGE_SIZE + 1] = {[0] = SSD1306_CTRL_DATA};
+
+static int ssd1306_i2c_xfer(const u8 *buf, int len)
+{
+	int ret;
+
+	bc_bus_get(BC_BUS_DISPLAY);
+	ret = i2c_master_send(ssd1306_client, buf, len);
+	bc_bus_put(BC_BUS_DISPLAY, len);
+
+	return ret;
+}
+
+/*
+ * Bulk data goes in chunks, each with its own control byte, so sensor
+ * transfers get the bus in between. GDDRAM pointer carries over.
+ */
+static int ssd1306_i2c_send(const u8 *buf, int len)
+{
+	int ret, n, off;
+	int chunk = bc_bus_chunk_size();
+	u8 tmp[BC_BUS_MAX_CHUNK + 1];
+
+	if (len <= chunk + 1)
+		return ssd1306_i2c_xfer(buf, len);
+
+	tmp[0] = buf[0];
+	for (off = 1; off < len; off += n) {
+		n = min(chunk, len - off);
+		memcpy(&tmp[1], &buf[off], n);
+		ret = ssd1306_i2c_xfer(tmp, n + 1);
+		if (ret < 0)
+			return ret;
+	}
+
+	return len;
+}
+
+static bool ssd1306_i2c_admit(void)
+{
+	return bc_bus_admit(BC_BUS_DISPLAY);
+}
+
+static const struct ssd1306_bus ssd1306_i2c_bus = {
+	.name = "i2c",
+	.send = ssd1306_i2c_send,
+	.admit = ssd1306_i2c_admit,
+};
+
+static inline int ssd1306_send(const u8 *buf, int len)
+{
+	return bus->send(buf, len);
+}
+
+/* Only drawing counts as a frame, not power management or setup */
+static inline int ssd1306_send_frame(const u8 *buf, int len)
+{
+	int ret = ssd1306_send(buf, len);
+
+	if (ret > 0)
+		frame_sent = true;
+
+	return ret;
+}
+
+static inline int ssd1306_i2c_cmd(unsigned char cmd)
+{
+	return ssd1306_send((u8[]){SSD1306_CTRL_CMD, cmd}, 2);
+}
+
+static inline int ssd1306_i2c_data(unsigned char data)
+{
+	return ssd1306_send((u8[]){SSD1306_CTRL_DATA, data}, 2);
+}
+
+static void shadow_window(u8 x0, u8 x1, u8 p0, u8 p1)
+{
+	shadow_pos.x0 = shadow_pos.x = x0;
+	shadow_pos.x1 = x1;
+	shadow_pos.p0 = shadow_pos.p = p0;
+	shadow_pos.p1 = p1;
+}
+
+/* Sets the GDDRAM window, a failed command leaves the shadow unknown */
+static int ssd1306_window(u8 x0, u8 x1, u8 p0, u8 p1)
+{
+	int i, ret = 0;
+	const u8 cmds[] = {
+		SSD1306_PAGEADDR, p0, p1,
+		SSD1306_COLUMNADDR, x0, x1,
+	};
+
+	for (i = 0; i < ARRAY_SIZE(cmds) && ret >= 0; i++)
+		ret = ssd1306_i2c_cmd(cmds[i]);
+
+	if (ret < 0) {
+		shadow_valid = false;
+		return ret;
+	}
+
+	shadow_window(x0, x1, p0, p1);
+
+	return 0;
+}
+
+/* @ret: result of the transfer that has sent @data */
+static void shadow_data(const u8 *data, int len, int ret)
+{
+	if (ret < 0) {
+		shadow_valid = false;
+		return;
+	}
+
+	while (len--) {
+		shadow[shadow_pos.p % SSD1306_PAGES]
+		      [shadow_pos.x % SSD1306_SEGMENTS] = *data++;
+
+		if (shadow_pos.x++ < shadow_pos.x1)
+			continue;
+
+		shadow_pos.x = shadow_pos.x0;
+		if (shadow_pos.p++ >= shadow_pos.p1)
+			shadow_pos.p = shadow_pos.p0;
+	}
+}
+
+/* Turns the panel back on before drawing */
+static int display_get(void)
+{
+	int ret;
+
+	if (ssd1306_dev == NULL) {
+		pr_err(MP "ssd1306 device not found!");
+		return -ENODEV;
+	}
+
+	ret = pm_runtime_resume_and_get(ssd1306_dev);
+	if (ret < 0)
+		dev_err(ssd1306_dev, "cannot resume: %d\n", ret);
+
+	return ret;
+}
+
+static void display_put(void)
+{
+	pm_runtime_mark_last_busy(ssd1306_dev);
+	pm_runtime_put_autosuspend(ssd1306_dev);
+}
+
+/* Frames over the bus budget are dropped as a whole */
+static bool display_admit(void)
+{
+	if (frame == FRAME_OPEN)
+		frame = !bus->admit || bus->admit() ?
+			FRAME_ADMITTED : FRAME_SHED;
+
+	return frame == FRAME_ADMITTED;
+}
+
+static int display_clear(void)
+{
+	int ret;
+	u8 *buf;
+
+	buf = kzalloc(DISPLAY_IMAGE_SIZE + 1, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	buf[0] = 0x40;
+
+	ret = ssd1306_window(0, SSD1306_SEGMENTS - 1, 0, SSD1306_PAGES - 1);
+	if (ret < 0)
+		goto out;
+
+	ret = ssd1306_send(buf, DISPLAY_IMAGE_SIZE + 1);
+
+	shadow_data(&buf[1], DISPLAY_IMAGE_SIZE, ret);
+	if (ret >= 0)
+		shadow_valid = true;
+
+out:
+	kfree(buf);
+
+	return ret;
+}
+
+/**
+ * bc_display_clear() - clears display
+ *
+ * Clears display filling all GDDRAM with zeroes
+ *
+ * Return: 0 on success. Error code on error.
+ */
+int bc_display_clear(void)
+{
+	int ret;
+
+	ret = display_get();
+	if (ret < 0)
+		return ret;
+
+	/* Screen would stay stale until the next mode switch, never shed */
+	frame = FRAME_ADMITTED;
+
+	trace_display_xfer_start(0, 0, SSD1306_SEGMENTS * SSD1306_PAGES);
+	ret = display_clear();
+	trace_display_xfer_end(0, 0, ret);
+	display_put();
+
+	/* Setup and removal clear the screen outside of frames */
+	if (ret > 0)
+		frame_sent = true;
+
+	return ret < 0 ? ret : 0;
+}
+EXPORT_SYMBOL(bc_display_clear);
+
+/**
+ * bc_display_print() - prints the text with selected font
+ * @offset: Left indent in sectors. One sector is 1 px
+ * @line: Top indent in pages. One page height is 8 px
+ * @font: Font id
+ * @str: String to print
+ *
+ * Nothing is sent if the current frame is shed over the bus budget. The
+ * first failed transfer ends the string.
+ *
+ * Return: 0 on success, -EAGAIN if the frame is shed. Error code on error.
+ */
+int bc_display_print(u8 offset, u8 line, enum display_font_id id, char *str)
+{
+	int i, x, maplen, ret;
+	const struct display_font_t *font = display_font(id);
+	const struct display_font_info *fi;
+
+	static u8 buf[SYM_BUF_SIZE] = {[0] = 0x40};
+
+	if (!font)
+		return -EINVAL;
+
+	if (!str)
+		return -EFAULT;
+
+	fi = &font->info;
+
+	if (ssd1306_dev && !display_admit())
+		return -EAGAIN;
+
+	ret = display_get();
+	if (ret < 0)
+		return ret;
+
+	trace_display_xfer_start(offset, line, strnlen(str, MAX_STR_LEN) *
+				 fi->cheight * fi->width);
+
+	if (fi->cheight == 1) {
+		// Set page and column start and end address
+		ret = ssd1306_window(offset, offset + strlen(str) * fi->space,
+				     line, line);
+
+		maplen = fi->width;
+
+		for (i = 0; ret >= 0 && i < str[i] && i < MAX_STR_LEN; i++) {
+			display_font_glyph(font, str[i], &buf[1]);
+			buf[maplen+1] = 0x00; /* space */
+			ret = ssd1306_send_frame(buf, maplen+2);
+			shadow_data(&buf[1], maplen+1, ret);
+		}
+
+	} else {
+		maplen = fi->cheight * fi->width;
+
+		for (i = 0; ret >= 0 && str[i] && i < MAX_STR_LEN; i++) {
+			x = offset + (i * fi->space);
+
+			// Set page and column start and end address
+			ret = ssd1306_window(x, x + fi->width - 1,
+					     line, line + fi->cheight - 1);
+			if (ret < 0)
+				break;
+
+			display_font_glyph(font, str[i], &buf[1]);
+			ret = ssd1306_send_frame(buf, maplen+1);
+			shadow_data(&buf[1], maplen, ret);
+		}
+	}
+
+	trace_display_xfer_end(offset, line, ret);
+	display_put();
+
+	return ret < 0 ? ret : 0;
+}
+EXPORT_SYMBOL(bc_display_print);
+
+/**
+ * bc_display_bitmap() - draws a raw bitmap
+ * @offset: Left indent in sectors. One sector is 1 px
+ * @line: Top indent in pages. One page height is 8 px
+ * @width: Bitmap width in sectors
+ * @pages: Bitmap height in pages
+ * @bitmap: Page-major bitmap, one byte is a column of 8 px of a page
+ *
+ * Sends the whole bitmap as a single data stream, split into bus chunks.
+ * Nothing is sent if the current frame is shed over the bus budget.
+ *
+ * Return: 0 on success, -EAGAIN if the frame is shed. Error code on error.
+ */
+int bc_display_bitmap(u8 offset, u8 line, u8 width, u8 pages,
+		      const u8 *bitmap)
+{
+	int ret, len;
+
+	if (!bitmap)
+		return -EFAULT;
+
+	if (!width || !pages || offset + width > SSD1306_SEGMENTS ||
+	    line + pages > SSD1306_PAGES)
+		return -EINVAL;
+
+	if (ssd1306_dev && !display_admit())
+		return -EAGAIN;
+
+	ret = display_get();
+	if (ret < 0)
+		return ret;
+
+	len = width * pages;
+
+	trace_display_xfer_start(offset, line, len);
+
+	ret = ssd1306_window(offset, offset + width - 1,
+			     line, line + pages - 1);
+	if (!ret) {
+		memcpy(&data_buf[1], bitmap, len);
+		ret = ssd1306_send_frame(data_buf, len + 1);
+		shadow_data(bitmap, len, ret);
+	}
+
+	trace_display_xfer_end(offset, line, ret);
+
+	display_put();
+
+	return ret < 0 ? ret : 0;
+}
+EXPORT_SYMBOL(bc_display_bitmap);
+
+/**
+ * bc_display_image() - shows a full screen image
+ * @image: DISPLAY_IMAGE_SIZE bytes, page-major
+ *
+ * Sends the span of pages that differ from the screen as one data stream,
+ * nothing if the image is already shown. Like bc_display_clear() it is
+ * never shed, it is what the screen is redrawn over.
+ *
+ * Return: 0 on success. Error code on error.
+ */
+int bc_display_image(const u8 *image)
+{
+	int ret, first = 0, last = SSD1306_PAGES - 1, len;
+
+	if (!image)
+		return -EFAULT;
+
+	ret = display_get();
+	if (ret < 0)
+		return ret;
+
+	frame = FRAME_ADMITTED;
+
+	if (shadow_valid) {
+		while (first <= last && !memcmp(shadow[first],
+				&image[first * SSD1306_SEGMENTS],
+				SSD1306_SEGMENTS))
+			first++;
+		while (last >= first && !memcmp(shadow[last],
+				&image[last * SSD1306_SEGMENTS],
+				SSD1306_SEGMENTS))
+			last--;
+	}
+
+	if (first > last)
+		goto out;
+
+	len = (last - first + 1) * SSD1306_SEGMENTS;
+
+	trace_display_xfer_start(0, first, len);
+
+	ret = ssd1306_window(0, SSD1306_SEGMENTS - 1, first, last);
+	if (!ret) {
+		memcpy(&data_buf[1], &image[first * SSD1306_SEGMENTS], len);
+		ret = ssd1306_send_frame(data_buf, len + 1);
+		shadow_data(&image[first * SSD1306_SEGMENTS], len, ret);
+	}
+
+	trace_display_xfer_end(0, first, ret);
+
+out:
+	display_put();
+
+	return ret < 0 ? ret : 0;
+}
+EXPORT_SYMBOL(bc_display_image);
+
+/**
+ * bc_display_flush() - marks the end of a frame
+ *
+ * Everything drawn since the previous call makes up one frame. The real
+ * panel shows data as it arrives, the emulator closes its per-frame
+ * transfer accounting here. Transfers are synchronous, so on return all
+ * pixels of the frame are on the panel.
+ *
+ * Return: 1 if the frame sent anything, 0 if it was empty.
+ * Error code on error.
+ */
+int bc_display_flush(void)
+{
+	bool sent = frame_sent;
+
+	if (ssd1306_dev == NULL)
+		return -ENODEV;
+
+	frame = FRAME_OPEN;
+	frame_sent = false;
+
+	if (bus->flush)
+		bus->flush();
+
+	return sent;
+}
+EXPORT_SYMBOL(bc_display_flush);
+
+/**
+ * bc_display_keepalive() - keep the panel on without drawing
+ *
+ * Drawing calls restart the blanking timeout, a frame that changes nothing
+ * on the screen makes none of them. Turns the panel back on if it has
+ * already blanked, otherwise it is just a busy mark.
+ *
+ * Return: 0 on success. Error code on error.
+ */
+int bc_display_keepalive(void)
+{
+	int ret;
+
+	ret = display_get();
+	if (ret < 0)
+		return ret;
+
+	display_put();
+
+	return 0;
+}
+EXPORT_SYMBOL(bc_display_keepalive);
+
+/**
+ * bc_display_epoch() - tell whether the screen has been lost
+ *
+ * The controller is set up again on system resume, which clears GDDRAM.
+ * Whatever was drawn before the number changed has to be drawn again.
+ *
+ * Return: number of controller setups so far.
+ */
+u32 bc_display_epoch(void)
+{
+	return atomic_read(&setups);
+}
+EXPORT_SYMBOL(bc_display_epoch);
+
+
+/* Full controller configuration, leaves the display off */
+static void ssd1306_setup(void)
+{
+	/* Display OFF */
+	ssd1306_i2c_cmd(SSD1306_DISPLAYOFF);
+
+	/* Set Display Clock Divide Ratio and Oscillator Frequency */
+	ssd1306_i2c_cmd(SSD1306_SETDISPLAYCLOCKDIV);
+	/* Default Setting for Display Clock Divide Ratio and Oscillator Frequency that is recommended */
+	ssd1306_i2c_cmd(0x80);
+
+	/* Set Multiplex Ratio */
+	ssd1306_i2c_cmd(SSD1306_SETMULTIPLEX);
+	/* 64 COM lines */
+	ssd1306_i2c_cmd(0x3F);
+
+	/* Set display offset */
+	ssd1306_i2c_cmd(SSD1306_SETDISPLAYOFFSET);
+	/* 0 offset */
+	ssd1306_i2c_cmd(0x00);
+
+	/* Set first line as the start line of the display */
+	ssd1306_i2c_cmd(SSD1306_SETSTARTLINE);
+
+	/* Charge pump */
+	ssd1306_i2c_cmd(SSD1306_CHARGEPUMP);
+	/* Enable charge dump during display on */
+	ssd1306_i2c_cmd(0x14);
+
+	/* Set memory addressing mode */
+	ssd1306_i2c_cmd(SSD1306_MEMORYMODE);
+	/* Horizontal addressing mode */
+	ssd1306_i2c_cmd(0x00);
+
+	/* Set segment remap with column address 127 mapped to segment 0 */
+	ssd1306_i2c_cmd(SSD1306_SEGREMAP);
+
+	/* Set com output scan direction, scan from com63 to com 0 */
+	ssd1306_i2c_cmd(SSD1306_COMSCANDEC);
+
+	/* Set com pins hardware configuration */
+	ssd1306_i2c_cmd(SSD1306_SETCOMPINS);
+	/* Alternative com pin configuration, disable com left/right remap */
+	ssd1306_i2c_cmd(0x12);
+
+	/* Set contrast control */
+	ssd1306_i2c_cmd(SSD1306_SETCONTRAST);
+	/* Set Contrast to 128 */
+	ssd1306_i2c_cmd(0x80);
+
+	/* Set pre-charge period */
+	ssd1306_i2c_cmd(SSD1306_SETPRECHARGE);
+	/* Phase 1 period of 15 DCLK, Phase 2 period of 1 DCLK */
+	ssd1306_i2c_cmd(0xF1);
+
+	/* Set Vcomh deselect level */
+	ssd1306_i2c_cmd(SSD1306_SETVCOMDETECT);
+	/* Vcomh deselect level ~ 0.77 Vcc */
+	ssd1306_i2c_cmd(0x20);
+
+	/* Entire display ON, resume to RAM content display */
+	ssd1306_i2c_cmd(SSD1306_DISPLAYALLON_RESUME);
+
+	/* Set Display in Normal Mode */
+	ssd1306_i2c_cmd(SSD1306_NORMALDISPLAY);
+
+	/* Deactivate scroll */
+	ssd1306_i2c_cmd(SSD1306_DEACTIVATE_SCROLL);
+
+	/* Clear display */
+	display_clear();
+
+	atomic_inc(&setups);
+}
+
+/* Common part of the I2C and the emulated device probe */
+static void ssd1306_attach(struct device *dev, const struct ssd1306_bus *b)
+{
+	bus = b;
+
+	/* Setup the device */
+	ssd1306_setup();
+
+	/* Display ON in normal mode */
+	ssd1306_i2c_cmd(SSD1306_DISPLAYON);
+
+	/* Panel is on, blank it when nothing is drawn for a while */
+	pm_runtime_set_active(dev);
+	pm_runtime_set_autosuspend_delay(dev, autosuspend_ms);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
+	pm_runtime_mark_last_busy(dev);
+
+	ssd1306_dev = dev;
+}
+
+static void ssd1306_detach(struct device *dev)
+{
+	pm_runtime_disable(dev);
+	pm_runtime_dont_use_autosuspend(dev);
+	pm_runtime_set_suspended(dev);
+
+	display_clear();
+	ssd1306_i2c_cmd(SSD1306_DISPLAYOFF);
+
+	ssd1306_dev = NULL;
+}
+
+static int ssd1306_probe(struct i2c_client *drv_client,
+			 const struct i2c_device_id *id)
+{
+	msleep(100);
+
+	pr_info(MP "probing...\n");
+
+	dev_info(&drv_client->dev,
+		"i2c client address is 0x%X\n", drv_client->addr);
+
+	ssd1306_client = drv_client;
+	ssd1306_attach(&drv_client->dev, &ssd1306_i2c_bus);
+
+	dev_info(&drv_client->dev, "i2c driver probed\n");
+
+	return 0;
+}
+
+static int ssd1306_remove(struct i2c_client *drv_client)
+{
+	ssd1306_detach(&drv_client->dev);
+
+	dev_info(&drv_client->dev, "i2c driver removed\n");
+	return 0;
+}
+
+static int ssd1306_emu_probe(struct platform_device *pdev)
+{
+	int ret;
+
+	ret = ssd1306_emu_init();
+	if (ret < 0)
+		return ret;
+
+	ssd1306_attach(&pdev->dev, &ssd1306_emu_bus);
+
+	dev_info(&pdev->dev, "emulated panel probed\n");
+
+	return 0;
+}
+
+static int ssd1306_emu_remove(struct platform_device *pdev)
+{
+	ssd1306_detach(&pdev->dev);
+	ssd1306_emu_exit();
+
+	dev_info(&pdev->dev, "emulated panel removed\n");
+	return 0;
+}
+
+/* Sleep mode keeps GDDRAM, so the picture is back as soon as it's on */
+static int ssd1306_runtime_suspend(struct device *dev)
+{
+	int ret;
+
+	ret = ssd1306_i2c_cmd(SSD1306_DISPLAYOFF);
+	if (ret < 0)
+		return ret;
+
+	ssd1306_i2c_cmd(SSD1306_CHARGEPUMP);
+	/* Disable charge pump */
+	ssd1306_i2c_cmd(0x10);
+
+	trace_display_power(false);
+
+	return 0;
+}
+
+static int ssd1306_runtime_resume(struct device *dev)
+{
+	int ret;
+
+	ssd1306_i2c_cmd(SSD1306_CHARGEPUMP);
+	/* Enable charge pump during display on */
+	ssd1306_i2c_cmd(0x14);
+
+	ret = ssd1306_i2c_cmd(SSD1306_DISPLAYON);
+	if (ret >= 0)
+		trace_display_power(true);
+
+	return ret < 0 ? ret : 0;
+}
+
+static int ssd1306_suspend(struct device *dev)
+{
+	return pm_runtime_force_suspend(dev);
+}
+
+/* The supply may have been cut, so the controller is set up again */
+static int ssd1306_resume(struct device *dev)
+{
+	ssd1306_setup();
+	ssd1306_runtime_suspend(dev);
+
+	return pm_runtime_force_resume(dev);
+}
+
+static const struct dev_pm_ops ssd1306_pm_ops = {
+	SET_SYSTEM_SLEEP_PM_OPS(ssd1306_suspend, ssd1306_resume)
+	SET_RUNTIME_PM_OPS(ssd1306_runtime_suspend, ssd1306_runtime_resume,
+			   NULL)
+};
+
+static const struct i2c_device_id ssd1306_id[] = {
+	{ I2C_DEVICE_NAME, 0 },
+	{ }
+};
+MODULE_DEVICE_TABLE(i2c, ssd1306_id);
+
+static struct i2c_driver ssd1306_i2c_driver = {
+	.driver = {
+		.name = I2C_DEVICE_NAME,
+		.owner = THIS_MODULE,
+		.pm = &ssd1306_pm_ops,
+	},
+	.probe = ssd1306_probe,
+	.remove = ssd1306_remove,
+	.id_table = ssd1306_id,
+};
+
+static struct platform_driver ssd1306_emu_driver = {
+	.driver = {
+		.name = EMU_DEVICE_NAME,
+		.owner = THIS_MODULE,
+		.pm = &ssd1306_pm_ops,
+	},
+	.probe = ssd1306_emu_probe,
+	.remove = ssd1306_emu_remove,
+};
+
+static struct i2c_board_info ssd1306_i2c_device_info = {
+	I2C_BOARD_INFO(I2C_DEVICE_NAME, SSD1306_I2C_ADDR)
+};
+
+static int __init display_emu_init(void)
+{
+	int ret;
+
+	ret = platform_driver_register(&ssd1306_emu_driver);
+	if (ret < 0) {
+		pr_err(MP "failed to register emulator driver: %d\n", ret);
+		return ret;
+	}
+
+	emu_pdev = platform_device_register_simple(EMU_DEVICE_NAME, -1,
+						   NULL, 0);
+	if (IS_ERR(emu_pdev)) {
+		pr_err(MP "failed to create emulated panel\n");
+		platform_driver_unregister(&ssd1306_emu_driver);
+		return PTR_ERR(emu_pdev);
+	}
+
+	pr_info(MP "emulated panel created\n");
+
+	return 0;
+}
+
+static int __init display_mod_init(void)
+{
+	int ret;
+	struct i2c_adapter *adapter;
+
+	pr_info(MP "initialization...\n");
+
+	if (emu)
+		return display_emu_init();
+
+	adapter = i2c_get_adapter(I2C_BUS);
+
+	pr_info(MP "adapter = 0x%p\n", adapter);
+
+	if (!adapter) {
+		pr_err(MP "failed to get I2C adapter\n");
+		return -ENODEV;
+	}
+
+	/* Create i2c client */
+	ssd1306_client = i2c_new_client_device(adapter,
+					       &ssd1306_i2c_device_info);
+
+	pr_info(MP "client = 0x%p\n", ssd1306_client);
+
+	if (!ssd1306_client) {
+		pr_err(MP "failed to create I2C client\n");
+		i2c_put_adapter(adapter);
+		return -ENODEV;
+	}
+
+	/* Create i2c driver */
+	ret = i2c_add_driver(&ssd1306_i2c_driver);
+	if (ret != 0) {
+		pr_err(MP "failed to add new i2c driver: %d\n", ret);
+		return ret;
+	}
+
+	i2c_put_adapter(adapter);
+
+	pr_info(MP "i2c driver created\n");
+
+	return 0;
+}
+
+static void __exit display_mod_exit(void)
+{
+	if (emu) {
+		platform_device_unregister(emu_pdev);
+		platform_driver_unregister(&ssd1306_emu_driver);
+	} else {
+		i2c_unregister_device(ssd1306_client);
+		i2c_del_driver(&ssd1306_i2c_driver);
+	}
+	pr_info(MP "module removed\n");
+}
+
+module_init(display_mod_init);
+module_exit(display_mod_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Linux Kernel Bootcamp Project: Display Module");
+MODULE_AUTHOR("Vlad Degtyarov <deesyync@gmail.com>");
+MODULE_VERSION("0.1");
@@ -1,6 +1,6 @@
 /* SPDX-License-Identifier: GPL */
 
-/* Display fonts bitmap and meta information */
+/* Display fonts bitmap and meta information, display module internal */
 
 #ifndef __DISPLAY_FONTS_H__
 #define __DISPLAY_FONTS_H__
@@ -8,484 +8,12 @@
 #define SYM_BUF_SIZE 64	/* cheight*width+1 of the biggest font */
 
 struct display_font_t {
-	u8 cheight;
-	u8 width;
-	u8 space;
-	u8 symbols_count;
-	u8 first_symbol;
-	u8 map[];
+	struct display_font_info info;
+	bool compact;			/* Glyphs are trimmed, see display_fonts.c */
+	const u8 *map;
 };
 
-static const struct display_font_t lcd_font24 = {
-	.cheight = 3,
-	.width = 13,
-	.space = 15,
-	.symbols_count = 14,
-	.first_symbol = 44,
-	.map = {
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // (err space)
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x10, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x10, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // -
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0xe0, 0xe0, 0x40, 0x00, 0x00, 0x00, 0x00, // .
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0xfc, 0xfa, 0xf6, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xf6, 0xfa, 0xfc,
-	0x00, 0xef, 0xc7, 0x83, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0xc7, 0xef,
-	0x00, 0x7f, 0xbf, 0xdf, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xdf, 0xbf, 0x7f, // 0
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0xf8, 0xfc,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0xc7, 0xef,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x3f, 0x7f, // 1
-	0x00, 0x00, 0x02, 0x06, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xf6, 0xfa, 0xfc,
-	0x00, 0xe0, 0xd0, 0xb8, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x3b, 0x17, 0x0f,
-	0x00, 0x7f, 0xbf, 0xdf, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xc0, 0x80, 0x00, // 2
-	0x00, 0x00, 0x02, 0x06, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xf6, 0xfa, 0xfc,
-	0x00, 0x00, 0x10, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0xbb, 0xd7, 0xef,
-	0x00, 0x00, 0x80, 0xc0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xdf, 0xbf, 0x7f, // 3
-	0x00, 0xfc, 0xf8, 0xf0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0, 0xf8, 0xfc,
-	0x00, 0x0f, 0x17, 0x3b, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0xbb, 0xd7, 0xef,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x3f, 0x7f, // 4
-	0x00, 0xfc, 0xfa, 0xf6, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x06, 0x02, 0x00,
-	0x00, 0x0f, 0x17, 0x3b, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0xb8, 0xd0, 0xe0,
-	0x00, 0x00, 0x80, 0xc0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xdf, 0xbf, 0x7f, // 5
-	0x00, 0xfc, 0xfa, 0xf6, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x06, 0x02, 0x00,
-	0x00, 0xef, 0xd7, 0xbb, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0xb8, 0xd0, 0xe0,
-	0x00, 0x7f, 0xbf, 0xdf, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xdf, 0xbf, 0x7f, // 6
-	0x00, 0x00, 0x02, 0x06, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xf6, 0xfa, 0xfc,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x83, 0xc7, 0xef,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x3f, 0x7f, // 7
-	0x00, 0xfc, 0xfa, 0xf6, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xf6, 0xfa, 0xfc,
-	0x00, 0xef, 0xd7, 0xbb, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0xbb, 0xd7, 0xef,
-	0x00, 0x7f, 0xbf, 0xdf, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xdf, 0xbf, 0x7f, // 8
-	0x00, 0xfc, 0xfa, 0xf6, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0x0e, 0xf6, 0xfa, 0xfc,
-	0x00, 0x0f, 0x17, 0x3b, 0x38, 0x38, 0x38, 0x38, 0x38, 0x38, 0xbb, 0xd7, 0xef,
-	0x00, 0x00, 0x80, 0xc0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xe0, 0xdf, 0xbf, 0x7f, // 9
-	}
-};
-
-static const struct display_font_t bolder_font16 = {
-	.cheight = 2,
-	.width = 10,
-	.space = 10,
-	.symbols_count = 95,
-	.first_symbol = 32,
-	.map = {
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // (space)
-	0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x19, 0x19, 0x00, 0x00, 0x00, 0x00,  // !
-	0x00, 0x00, 0x1e, 0x1e, 0x00, 0x00, 0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // "
-	0x00, 0x30, 0xfe, 0xfe, 0x30, 0x30, 0xfe, 0xfe, 0x30, 0x00, 0x00, 0x03, 0x1f, 0x1f, 0x03, 0x03, 0x1f, 0x1f, 0x03, 0x00,  // #
-	0x00, 0x70, 0xf8, 0xd8, 0xfe, 0x98, 0x98, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x18, 0x18, 0x7f, 0x19, 0x1f, 0x0f, 0x00, 0x00,  // $
-	0x1c, 0xb6, 0xa2, 0xf6, 0xcc, 0x60, 0x60, 0x20, 0x30, 0x00, 0x01, 0x01, 0x00, 0x0e, 0x1b, 0x11, 0x1b, 0x0e, 0x00, 0x00,  // %
-	0x00, 0x00, 0xdc, 0x7e, 0xe6, 0xc6, 0x86, 0x0c, 0x80, 0x80, 0x00, 0x07, 0x0f, 0x1c, 0x18, 0x19, 0x1f, 0x1e, 0x1f, 0x13,  // &
-	0x00, 0x00, 0x00, 0x00, 0x1e, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // '
-	0x00, 0x00, 0x00, 0xe0, 0xfc, 0x1e, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x07, 0x3f, 0x78, 0x40, 0x00, 0x00, 0x00,  // (
-	0x00, 0x00, 0x02, 0x1e, 0xfc, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x78, 0x3f, 0x07, 0x00, 0x00, 0x00, 0x00,  // )
-	0x00, 0x48, 0x78, 0x30, 0xfe, 0x30, 0x78, 0x48, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00,  // *
-	0x00, 0x80, 0x80, 0x80, 0xf0, 0xf0, 0x80, 0x80, 0x80, 0x00, 0x00, 0x01, 0x01, 0x01, 0x0f, 0x0f, 0x01, 0x01, 0x01, 0x00,  // +
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x7c, 0x3c, 0x00, 0x00, 0x00, 0x00,  // ,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x00, 0x00, 0x00,  // -
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x1c, 0x00, 0x00, 0x00, 0x00,  // .
-	0x00, 0x00, 0x00, 0x00, 0xc0, 0xf0, 0x3c, 0x0e, 0x02, 0x00, 0x00, 0x20, 0x38, 0x1e, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00,  // /
-	0x00, 0xf0, 0xfc, 0x0e, 0xc6, 0xc6, 0x0e, 0xfc, 0xf8, 0x00, 0x00, 0x03, 0x0f, 0x1c, 0x18, 0x18, 0x1c, 0x0f, 0x07, 0x00,  // 0
-	0x00, 0x00, 0x0c, 0x06, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x1f, 0x1f, 0x18, 0x18, 0x18, 0x00,  // 1
-	0x00, 0x0c, 0x06, 0x06, 0x06, 0x86, 0xc6, 0x7c, 0x38, 0x00, 0x00, 0x18, 0x1c, 0x1e, 0x1b, 0x19, 0x18, 0x18, 0x18, 0x00,  // 2
-	0x00, 0x0c, 0x06, 0xc6, 0xc6, 0xc6, 0xc6, 0xfc, 0x38, 0x00, 0x00, 0x0c, 0x18, 0x18, 0x18, 0x18, 0x19, 0x0f, 0x0f, 0x00,  // 3
-	0x00, 0x80, 0xc0, 0x70, 0x18, 0x0e, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x03, 0x03, 0x03, 0x03, 0x03, 0x1f, 0x1f, 0x03, 0x00,  // 4
-	0x00, 0xfe, 0x7e, 0x66, 0x66, 0x66, 0xe6, 0xc6, 0x80, 0x00, 0x00, 0x0c, 0x18, 0x18, 0x18, 0x18, 0x1c, 0x0f, 0x07, 0x00,  // 5
-	0x00, 0xf0, 0xfc, 0xce, 0x66, 0x66, 0xe6, 0xcc, 0x80, 0x00, 0x00, 0x07, 0x0f, 0x1c, 0x18, 0x18, 0x1c, 0x0f, 0x07, 0x00,  // 6
-	0x00, 0x06, 0x06, 0x06, 0x06, 0xe6, 0xfe, 0x3e, 0x0e, 0x00, 0x00, 0x00, 0x10, 0x1c, 0x0f, 0x03, 0x00, 0x00, 0x00, 0x00,  // 7
-	0x00, 0x38, 0xfc, 0xc6, 0xc6, 0xc6, 0xc6, 0xfc, 0x38, 0x00, 0x00, 0x0f, 0x0f, 0x18, 0x18, 0x18, 0x18, 0x0f, 0x0f, 0x00,  // 8
-	0x00, 0x78, 0xfc, 0xce, 0x86, 0x86, 0xce, 0xfc, 0xf8, 0x00, 0x00, 0x00, 0x0c, 0x19, 0x19, 0x19, 0x1c, 0x0f, 0x03, 0x00,  // 9
-	0x00, 0x00, 0x00, 0x00, 0xe0, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1c, 0x1c, 0x00, 0x00, 0x00, 0x00,  // :
-	0x00, 0x00, 0x00, 0x00, 0xe0, 0xe0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x7c, 0x3c, 0x00, 0x00, 0x00, 0x00,  // ;
-	0x00, 0x80, 0x80, 0xc0, 0x40, 0x60, 0x60, 0x20, 0x30, 0x00, 0x00, 0x01, 0x01, 0x03, 0x02, 0x06, 0x06, 0x04, 0x0c, 0x00,  // <
-	0x00, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x60, 0x00, 0x00, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x06, 0x00,  // =
-	0x00, 0x30, 0x20, 0x60, 0x60, 0x40, 0xc0, 0x80, 0x80, 0x00, 0x00, 0x0c, 0x04, 0x06, 0x06, 0x02, 0x03, 0x01, 0x01, 0x00,  // >
-	0x00, 0x0c, 0x06, 0x86, 0xc6, 0x66, 0x7e, 0x1c, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1b, 0x1b, 0x00, 0x00, 0x00, 0x00, 0x00,  // ?
-	0xe0, 0xf0, 0x38, 0x9c, 0xcc, 0xcc, 0xdc, 0xf8, 0xf0, 0x00, 0x07, 0x1f, 0x38, 0x73, 0x67, 0x66, 0x66, 0x77, 0x27, 0x00,  // @
-	0x00, 0x00, 0xc0, 0xfc, 0x3e, 0x3e, 0xfc, 0xc0, 0x00, 0x00, 0x00, 0x18, 0x1f, 0x0f, 0x03, 0x03, 0x0f, 0x1f, 0x18, 0x00,  // A
-	0x00, 0xfe, 0xfe, 0xc6, 0xc6, 0xc6, 0xc6, 0xfc, 0x3c, 0x00, 0x00, 0x1f, 0x1f, 0x18, 0x18, 0x18, 0x18, 0x1f, 0x0f, 0x00,  // B
-	0x00, 0xf0, 0xfc, 0x0c, 0x06, 0x06, 0x06, 0x06, 0x0c, 0x00, 0x00, 0x03, 0x0f, 0x0c, 0x18, 0x18, 0x18, 0x18, 0x0c, 0x00,  // C
-	0x00, 0xfe, 0xfe, 0x06, 0x06, 0x06, 0x0c, 0xfc, 0xf0, 0x00, 0x00, 0x1f, 0x1f, 0x18, 0x18, 0x18, 0x0c, 0x0f, 0x03, 0x00,  // D
-	0x00, 0xfe, 0xfe, 0xc6, 0xc6, 0xc6, 0xc6, 0xc6, 0x06, 0x00, 0x00, 0x1f, 0x1f, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00,  // E
-	0x00, 0xfe, 0xfe, 0xc6, 0xc6, 0xc6, 0xc6, 0xc6, 0x06, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // F
-	0x00, 0xf0, 0xfc, 0x0c, 0x06, 0x86, 0x86, 0x86, 0x8c, 0x00, 0x00, 0x03, 0x0f, 0x0c, 0x18, 0x19, 0x19, 0x1f, 0x0f, 0x00,  // G
-	0x00, 0xfe, 0xfe, 0xc0, 0xc0, 0xc0, 0xc0, 0xfe, 0xfe, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00,  // H
-	0x00, 0x00, 0x06, 0x06, 0xfe, 0xfe, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x1f, 0x1f, 0x18, 0x18, 0x00, 0x00,  // I
-	0x00, 0x00, 0x00, 0x00, 0x06, 0x06, 0x06, 0xfe, 0xfe, 0x00, 0x00, 0x0c, 0x18, 0x18, 0x18, 0x18, 0x18, 0x0f, 0x0f, 0x00,  // J
-	0x00, 0xfe, 0xfe, 0xe0, 0xf0, 0xfc, 0x0e, 0x06, 0x02, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x03, 0x0f, 0x1e, 0x18, 0x00,  // K
-	0x00, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x18, 0x18, 0x18, 0x18, 0x18, 0x18, 0x00,  // L
-	0x00, 0xfe, 0xfe, 0x3e, 0xf0, 0xf0, 0x3e, 0xfe, 0xfe, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x01, 0x01, 0x00, 0x1f, 0x1f, 0x00,  // M
-	0x00, 0xfe, 0xfe, 0x1e, 0xf0, 0xc0, 0x00, 0xfe, 0xfe, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x03, 0x1e, 0x1f, 0x1f, 0x00,  // N
-	0x00, 0xf0, 0xfc, 0x0e, 0x06, 0x06, 0x0e, 0xfc, 0xf0, 0x00, 0x00, 0x03, 0x0f, 0x1c, 0x18, 0x18, 0x1c, 0x0f, 0x03, 0x00,  // O
-	0x00, 0xfe, 0xfe, 0xc6, 0xc6, 0xc6, 0xc6, 0x7c, 0x7c, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // P
-	0x00, 0xf0, 0xfc, 0x0e, 0x06, 0x06, 0x0e, 0xfc, 0xf0, 0x00, 0x00, 0x03, 0x0f, 0x1c, 0x18, 0x18, 0x3c, 0x6f, 0x07, 0x00,  // Q
-	0x00, 0xfe, 0xfe, 0xc6, 0xc6, 0xc6, 0xc6, 0xfc, 0x3c, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x01, 0x03, 0x1f, 0x1e, 0x10,  // R
-	0x00, 0x38, 0x7c, 0xe6, 0xc6, 0xc6, 0xc6, 0x8c, 0x00, 0x00, 0x00, 0x0c, 0x18, 0x18, 0x18, 0x18, 0x19, 0x0f, 0x0f, 0x00,  // S
-	0x00, 0x06, 0x06, 0x06, 0xfe, 0xfe, 0x06, 0x06, 0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00,  // T
-	0x00, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0x00, 0x00, 0x07, 0x0f, 0x1c, 0x18, 0x18, 0x1c, 0x0f, 0x07, 0x00,  // U
-	0x00, 0x06, 0xfe, 0xfc, 0x00, 0x00, 0xfc, 0xfe, 0x06, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x1f, 0x1f, 0x00, 0x00, 0x00,  // V
-	0x1e, 0xfe, 0xe0, 0x00, 0xf0, 0xf0, 0x00, 0xe0, 0xfe, 0x1e, 0x00, 0x1f, 0x1f, 0x1e, 0x01, 0x01, 0x1e, 0x1f, 0x1f, 0x00,  // W
-	0x00, 0x02, 0x0e, 0x3e, 0xf8, 0xf8, 0x3e, 0x0e, 0x02, 0x00, 0x00, 0x10, 0x1c, 0x1f, 0x03, 0x03, 0x1f, 0x1c, 0x10, 0x00,  // X
-	0x02, 0x0e, 0x3e, 0x78, 0xe0, 0xe0, 0x78, 0x3e, 0x0e, 0x02, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00,  // Y
-	0x00, 0x06, 0x06, 0x86, 0xc6, 0xf6, 0x7e, 0x1e, 0x0e, 0x00, 0x00, 0x1c, 0x1e, 0x1f, 0x1b, 0x18, 0x18, 0x18, 0x18, 0x00,  // Z
-	0x00, 0x00, 0x00, 0xfe, 0xfe, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x40, 0x40, 0x00, 0x00, 0x00,  // [
-	0x00, 0x02, 0x0e, 0x38, 0xe0, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0e, 0x38, 0x20, 0x00,  // (backslash)
-	0x00, 0x00, 0x02, 0x02, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00,  // ]
-	0x10, 0x18, 0x1c, 0x0e, 0x06, 0x0e, 0x1c, 0x18, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // ^
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x40,  // _
-	0x00, 0x00, 0x01, 0x03, 0x06, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // `
-	0x00, 0x00, 0x60, 0x30, 0xb0, 0xb0, 0xb0, 0xf0, 0xe0, 0x00, 0x00, 0x0e, 0x1f, 0x1b, 0x19, 0x19, 0x0d, 0x1f, 0x1f, 0x00,  // a
-	0x00, 0xfe, 0xfe, 0x60, 0x30, 0x30, 0x70, 0xe0, 0xc0, 0x00, 0x00, 0x1f, 0x1f, 0x0c, 0x18, 0x18, 0x1c, 0x0f, 0x07, 0x00,  // b
-	0x00, 0xc0, 0xe0, 0x70, 0x30, 0x30, 0x30, 0x30, 0x60, 0x00, 0x00, 0x07, 0x0f, 0x1c, 0x18, 0x18, 0x18, 0x18, 0x0c, 0x00,  // c
-	0x00, 0xc0, 0xe0, 0x70, 0x30, 0x30, 0x60, 0xfe, 0xfe, 0x00, 0x00, 0x07, 0x0f, 0x1c, 0x18, 0x18, 0x0c, 0x1f, 0x1f, 0x00,  // d
-	0x00, 0xc0, 0xe0, 0xb0, 0xb0, 0xb0, 0xb0, 0xe0, 0xc0, 0x00, 0x00, 0x07, 0x0f, 0x1d, 0x19, 0x19, 0x19, 0x19, 0x0d, 0x00,  // e
-	0x00, 0x30, 0x30, 0xfc, 0xfe, 0x36, 0x36, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00,  // f
-	0x00, 0xc0, 0xe0, 0x70, 0x30, 0x30, 0x60, 0xf0, 0xf0, 0x00, 0x00, 0x03, 0x37, 0x6e, 0x6c, 0x6c, 0x66, 0x7f, 0x3f, 0x00,  // g
-	0x00, 0xfe, 0xfe, 0x60, 0x30, 0x30, 0x30, 0xf0, 0xe0, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00,  // h
-	0x00, 0x00, 0x30, 0x30, 0xf7, 0xf7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x18, 0x18, 0x1f, 0x1f, 0x18, 0x18, 0x18, 0x00,  // i
-	0x00, 0x00, 0x30, 0x30, 0xf7, 0xf7, 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x60, 0x7f, 0x3f, 0x00, 0x00, 0x00, 0x00,  // j
-	0x00, 0xfe, 0xfe, 0x80, 0xe0, 0x70, 0x30, 0x10, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x01, 0x03, 0x07, 0x1e, 0x18, 0x10, 0x00,  // k
-	0x00, 0x06, 0x06, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x1f, 0x18, 0x18, 0x18, 0x00, 0x00,  // l
-	0x00, 0xf0, 0xf0, 0x30, 0xf0, 0xe0, 0x30, 0xf0, 0xe0, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x1f, 0x1f, 0x00, 0x1f, 0x1f, 0x00,  // m
-	0x00, 0xf0, 0xf0, 0x60, 0x30, 0x30, 0x30, 0xf0, 0xe0, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00,  // n
-	0x00, 0xc0, 0xe0, 0x70, 0x30, 0x30, 0x70, 0xe0, 0xc0, 0x00, 0x00, 0x07, 0x0f, 0x1c, 0x18, 0x18, 0x1c, 0x0f, 0x07, 0x00,  // o
-	0x00, 0xf0, 0xf0, 0x60, 0x30, 0x30, 0x70, 0xe0, 0xc0, 0x00, 0x00, 0x7f, 0x7f, 0x06, 0x0c, 0x0c, 0x0e, 0x07, 0x03, 0x00,  // p
-	0x00, 0xc0, 0xe0, 0x70, 0x30, 0x30, 0x60, 0xf0, 0xf0, 0x00, 0x00, 0x03, 0x07, 0x0e, 0x0c, 0x0c, 0x06, 0x7f, 0x7f, 0x00,  // q
-	0x00, 0x00, 0xf0, 0xf0, 0x60, 0x30, 0x30, 0x30, 0x30, 0x00, 0x00, 0x00, 0x1f, 0x1f, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // r
-	0x00, 0xe0, 0xf0, 0xb0, 0xb0, 0xb0, 0xb0, 0x30, 0x60, 0x00, 0x00, 0x0c, 0x19, 0x19, 0x19, 0x19, 0x1b, 0x1f, 0x0e, 0x00,  // s
-	0x00, 0x30, 0x30, 0xfc, 0xfc, 0x30, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x1f, 0x18, 0x18, 0x18, 0x00, 0x00,  // t
-	0x00, 0xf0, 0xf0, 0x00, 0x00, 0x00, 0x00, 0xf0, 0xf0, 0x00, 0x00, 0x0f, 0x1f, 0x18, 0x18, 0x18, 0x0c, 0x1f, 0x1f, 0x00,  // u
-	0x00, 0x30, 0xf0, 0xe0, 0x00, 0x00, 0xe0, 0xf0, 0x30, 0x00, 0x00, 0x00, 0x01, 0x0f, 0x1e, 0x1e, 0x0f, 0x01, 0x00, 0x00,  // v
-	0x70, 0xf0, 0x00, 0x00, 0xc0, 0xc0, 0x00, 0x00, 0xf0, 0x70, 0x00, 0x07, 0x1f, 0x1e, 0x03, 0x03, 0x1e, 0x1f, 0x07, 0x00,  // w
-	0x00, 0x10, 0x30, 0xf0, 0xc0, 0xc0, 0xf0, 0x30, 0x10, 0x00, 0x00, 0x10, 0x18, 0x1e, 0x07, 0x07, 0x1e, 0x18, 0x10, 0x00,  // x
-	0x00, 0x10, 0xf0, 0xf0, 0x80, 0x00, 0xf0, 0xf0, 0x30, 0x00, 0x00, 0x00, 0x60, 0x63, 0x7f, 0x1f, 0x0f, 0x01, 0x00, 0x00,  // y
-	0x00, 0x30, 0x30, 0x30, 0x30, 0xb0, 0xf0, 0x70, 0x30, 0x00, 0x00, 0x18, 0x1c, 0x1e, 0x1b, 0x19, 0x18, 0x18, 0x18, 0x00,  // z
-	0x00, 0x00, 0x00, 0x00, 0xfc, 0xfe, 0x02, 0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x3e, 0x7e, 0x40, 0x40, 0x00, 0x00,  // {
-	0x00, 0x00, 0x00, 0x00, 0xfe, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x7f, 0x7f, 0x00, 0x00, 0x00, 0x00,  // |
-	0x00, 0x00, 0x02, 0x02, 0xfe, 0xfc, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x40, 0x40, 0x7e, 0x3e, 0x01, 0x01, 0x00, 0x00,  // }
-	0x00, 0x80, 0xc0, 0xc0, 0xc0, 0x80, 0x80, 0x80, 0xc0, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x00, 0x00,  // ~
-	}
-};
-
-static const struct display_font_t fixed_font16 = {
-	.cheight = 2,
-	.width = 6,
-	.space = 7,
-	.symbols_count = 95,
-	.first_symbol = 32,
-	.map = {
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00,
-	0x00, 0x00, 0x1E, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x20, 0xFC, 0x20, 0xFC, 0x20, 0x00, 0x01, 0x0F, 0x01, 0x0F, 0x01,
-	0x30, 0x48, 0x88, 0xFC, 0x88, 0x30, 0x06, 0x08, 0x08, 0x1F, 0x08, 0x07,
-	0x18, 0x24, 0xA4, 0x78, 0x10, 0x0C, 0x0C, 0x02, 0x07, 0x09, 0x09, 0x06,
-	0x00, 0xB8, 0xC4, 0x44, 0x38, 0x80, 0x07, 0x08, 0x08, 0x05, 0x06, 0x09,
-	0x00, 0x00, 0x00, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0xE0, 0x18, 0x04, 0x02, 0x00, 0x00, 0x03, 0x0C, 0x10, 0x20,
-	0x00, 0x02, 0x04, 0x18, 0xE0, 0x00, 0x00, 0x20, 0x10, 0x0C, 0x03, 0x00,
-	0x00, 0x20, 0x40, 0xF0, 0x40, 0x20, 0x00, 0x02, 0x01, 0x07, 0x01, 0x02,
-	0x00, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x00, 0x00, 0x00, 0x07, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x1C, 0x00, 0x00,
-	0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x08, 0x1C, 0x08, 0x00,
-	0x00, 0x00, 0x00, 0xE0, 0x18, 0x06, 0x30, 0x0C, 0x03, 0x00, 0x00, 0x00,
-	0xF0, 0x08, 0x04, 0x04, 0x08, 0xF0, 0x03, 0x04, 0x08, 0x08, 0x04, 0x03,
-	0x00, 0x10, 0x08, 0xFC, 0x00, 0x00, 0x00, 0x08, 0x08, 0x0F, 0x08, 0x08,
-	0x18, 0x04, 0x04, 0x04, 0xC4, 0x38, 0x08, 0x0C, 0x0A, 0x09, 0x08, 0x08,
-	0x04, 0x04, 0x44, 0x64, 0x54, 0x8C, 0x06, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0x00, 0xC0, 0x30, 0x08, 0xFC, 0x00, 0x03, 0x02, 0x02, 0x02, 0x0F, 0x02,
-	0x7C, 0x24, 0x24, 0x24, 0x24, 0xC4, 0x06, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0xF0, 0x88, 0x44, 0x44, 0x44, 0x80, 0x07, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0x04, 0x04, 0x04, 0xC4, 0x34, 0x0C, 0x00, 0x0C, 0x03, 0x00, 0x00, 0x00,
-	0x18, 0xA4, 0x44, 0x44, 0xA4, 0x18, 0x07, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0x78, 0x84, 0x84, 0x84, 0x44, 0xF8, 0x06, 0x08, 0x08, 0x08, 0x04, 0x03,
-	0x00, 0x00, 0x20, 0x70, 0x20, 0x00, 0x00, 0x00, 0x04, 0x0E, 0x04, 0x00,
-	0x00, 0x00, 0x60, 0x60, 0x00, 0x00, 0x00, 0x00, 0x12, 0x0E, 0x00, 0x00,
-	0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, 0x00, 0x01, 0x02, 0x04, 0x08,
-	0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
-	0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x08, 0x04, 0x02, 0x01, 0x00,
-	0x18, 0x04, 0x04, 0xC4, 0x24, 0x18, 0x00, 0x00, 0x00, 0x0D, 0x00, 0x00,
-	0xF0, 0x08, 0xE4, 0x14, 0x14, 0xF8, 0x03, 0x04, 0x09, 0x0A, 0x0A, 0x0B,
-	0xF0, 0x88, 0x84, 0x84, 0x88, 0xF0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x0F,
-	0xFC, 0x44, 0x44, 0x44, 0xA8, 0x10, 0x0F, 0x08, 0x08, 0x08, 0x04, 0x03,
-	0xF8, 0x04, 0x04, 0x04, 0x04, 0x18, 0x07, 0x08, 0x08, 0x08, 0x08, 0x06,
-	0xFC, 0x04, 0x04, 0x04, 0x08, 0xF0, 0x0F, 0x08, 0x08, 0x08, 0x04, 0x03,
-	0xFC, 0x44, 0x44, 0x44, 0x04, 0x04, 0x0F, 0x08, 0x08, 0x08, 0x08, 0x08,
-	0xFC, 0x44, 0x44, 0x44, 0x04, 0x04, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0xF8, 0x04, 0x04, 0x84, 0x84, 0x98, 0x07, 0x08, 0x08, 0x08, 0x04, 0x0F,
-	0xFC, 0x40, 0x40, 0x40, 0x40, 0xFC, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x0F,
-	0x00, 0x04, 0x04, 0xFC, 0x04, 0x04, 0x00, 0x08, 0x08, 0x0F, 0x08, 0x08,
-	0x00, 0x00, 0x00, 0x04, 0xFC, 0x04, 0x06, 0x08, 0x08, 0x08, 0x07, 0x00,
-	0xFC, 0x40, 0xA0, 0x10, 0x08, 0x04, 0x0F, 0x00, 0x00, 0x01, 0x02, 0x0C,
-	0xFC, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x08, 0x08, 0x08, 0x08, 0x08,
-	0xFC, 0x18, 0x60, 0x60, 0x18, 0xFC, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x0F,
-	0xFC, 0x30, 0x40, 0x80, 0x00, 0xFC, 0x0F, 0x00, 0x00, 0x00, 0x03, 0x0F,
-	0xF8, 0x04, 0x04, 0x04, 0x04, 0xF8, 0x07, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0xFC, 0x84, 0x84, 0x84, 0x84, 0x78, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0xF8, 0x04, 0x04, 0x04, 0x04, 0xF8, 0x07, 0x09, 0x09, 0x0A, 0x1C, 0x27,
-	0xFC, 0x84, 0x84, 0x84, 0x84, 0x78, 0x0F, 0x00, 0x00, 0x01, 0x02, 0x0C,
-	0x38, 0x44, 0x44, 0x84, 0x84, 0x18, 0x06, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0x04, 0x04, 0x04, 0xFC, 0x04, 0x04, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00,
-	0xFC, 0x00, 0x00, 0x00, 0x00, 0xFC, 0x07, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0x3C, 0xC0, 0x00, 0x00, 0xC0, 0x3C, 0x00, 0x01, 0x0E, 0x0E, 0x01, 0x00,
-	0x00, 0xFC, 0x00, 0x00, 0x00, 0xFC, 0x00, 0x07, 0x08, 0x07, 0x08, 0x07,
-	0x0C, 0x30, 0xC0, 0xC0, 0x30, 0x0C, 0x0C, 0x03, 0x00, 0x00, 0x03, 0x0C,
-	0x00, 0x1C, 0x60, 0x80, 0x60, 0x1C, 0x00, 0x00, 0x00, 0x0F, 0x00, 0x00,
-	0x04, 0x04, 0x84, 0x64, 0x14, 0x0C, 0x0C, 0x0B, 0x08, 0x08, 0x08, 0x08,
-	0x00, 0x00, 0xFE, 0x02, 0x02, 0x02, 0x00, 0x00, 0x3F, 0x20, 0x20, 0x20,
-	0x06, 0x18, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x0C, 0x30,
-	0x00, 0x02, 0x02, 0x02, 0xFE, 0x00, 0x00, 0x20, 0x20, 0x20, 0x3F, 0x00,
-	0x08, 0x04, 0x02, 0x02, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20,
-	0x00, 0x00, 0x02, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x40, 0x20, 0x20, 0x20, 0x20, 0xC0, 0x06, 0x09, 0x09, 0x09, 0x09, 0x0F,
-	0xFC, 0x40, 0x20, 0x20, 0x20, 0xC0, 0x0F, 0x04, 0x08, 0x08, 0x08, 0x07,
-	0xC0, 0x20, 0x20, 0x20, 0x20, 0x40, 0x07, 0x08, 0x08, 0x08, 0x08, 0x04,
-	0xC0, 0x20, 0x20, 0x20, 0x40, 0xFC, 0x07, 0x08, 0x08, 0x08, 0x04, 0x0F,
-	0xC0, 0x20, 0x20, 0x20, 0x20, 0xC0, 0x07, 0x09, 0x09, 0x09, 0x09, 0x05,
-	0x40, 0x40, 0xF8, 0x44, 0x44, 0x08, 0x00, 0x00, 0x0F, 0x00, 0x00, 0x00,
-	0xC0, 0x20, 0x20, 0x20, 0xC0, 0x20, 0x19, 0x26, 0x2A, 0x2A, 0x29, 0x10,
-	0xFC, 0x40, 0x20, 0x20, 0x20, 0xC0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x0F,
-	0x00, 0x00, 0x20, 0xEC, 0x00, 0x00, 0x00, 0x08, 0x08, 0x0F, 0x08, 0x08,
-	0x00, 0x00, 0x00, 0x00, 0x20, 0xEC, 0x00, 0x18, 0x20, 0x20, 0x20, 0x1F,
-	0xFC, 0x00, 0x80, 0x40, 0x20, 0x00, 0x0F, 0x01, 0x01, 0x02, 0x04, 0x08,
-	0x00, 0x00, 0x04, 0xFC, 0x00, 0x00, 0x00, 0x08, 0x08, 0x0F, 0x08, 0x08,
-	0x00, 0xE0, 0x20, 0xC0, 0x20, 0xC0, 0x00, 0x0F, 0x00, 0x07, 0x00, 0x0F,
-	0xE0, 0x40, 0x20, 0x20, 0x20, 0xC0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x0F,
-	0xC0, 0x20, 0x20, 0x20, 0x20, 0xC0, 0x07, 0x08, 0x08, 0x08, 0x08, 0x07,
-	0xE0, 0x40, 0x20, 0x20, 0x20, 0xC0, 0x3F, 0x04, 0x08, 0x08, 0x08, 0x07,
-	0xC0, 0x20, 0x20, 0x20, 0x40, 0xE0, 0x07, 0x08, 0x08, 0x08, 0x04, 0x3F,
-	0xE0, 0x40, 0x20, 0x20, 0x20, 0xC0, 0x0F, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x40, 0xA0, 0x20, 0x20, 0x20, 0x40, 0x04, 0x08, 0x09, 0x09, 0x0A, 0x04,
-	0x20, 0x20, 0xFC, 0x20, 0x20, 0x00, 0x00, 0x00, 0x07, 0x08, 0x08, 0x04,
-	0xE0, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x07, 0x08, 0x08, 0x08, 0x04, 0x0F,
-	0x00, 0xE0, 0x00, 0x00, 0x00, 0xE0, 0x00, 0x00, 0x03, 0x0C, 0x03, 0x00,
-	0x00, 0xE0, 0x00, 0x80, 0x00, 0xE0, 0x00, 0x07, 0x08, 0x07, 0x08, 0x07,
-	0x60, 0x80, 0x00, 0x00, 0x80, 0x60, 0x0C, 0x02, 0x01, 0x01, 0x02, 0x0C,
-	0xE0, 0x00, 0x00, 0x00, 0x00, 0xE0, 0x13, 0x24, 0x24, 0x24, 0x22, 0x1F,
-	0x20, 0x20, 0x20, 0xA0, 0x60, 0x20, 0x08, 0x0C, 0x0B, 0x08, 0x08, 0x08,
-	0x00, 0x00, 0x80, 0x7C, 0x02, 0x02, 0x00, 0x00, 0x00, 0x1F, 0x20, 0x20,
-	0x00, 0x00, 0x00, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x00, 0x00,
-	0x00, 0x02, 0x02, 0x7C, 0x80, 0x00, 0x00, 0x20, 0x20, 0x1F, 0x00, 0x00,
-	0x0C, 0x02, 0x04, 0x08, 0x10, 0x0C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-	}
-};
-
-static const struct display_font_t fixedb_font16 = {
-	.cheight = 2,
-	.width = 6,
-	.space = 7,
-	.symbols_count = 95,
-	.first_symbol = 32,
-	.map = {
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0xFC, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x0D, 0x0D, 0x00, 0x00,
-	0x00, 0x1E, 0x1E, 0x00, 0x1E, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x20, 0xFC, 0xFC, 0xFC, 0xFC, 0x20, 0x01, 0x0F, 0x0F, 0x0F, 0x0F, 0x01,
-	0x30, 0x48, 0xFC, 0xFC, 0x88, 0x30, 0x06, 0x08, 0x1F, 0x1F, 0x08, 0x07,
-	0x18, 0x3C, 0xA4, 0x78, 0x1C, 0x0C, 0x0C, 0x0E, 0x07, 0x09, 0x0F, 0x06,
-	0x00, 0xB8, 0xFC, 0x44, 0xFC, 0xB8, 0x07, 0x0F, 0x08, 0x07, 0x0F, 0x09,
-	0x00, 0x00, 0x1E, 0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0xE0, 0xF8, 0x1C, 0x06, 0x02, 0x00, 0x03, 0x0F, 0x1C, 0x30, 0x20,
-	0x00, 0x02, 0x06, 0x1C, 0xF8, 0xE0, 0x00, 0x20, 0x30, 0x1C, 0x0F, 0x03,
-	0x8C, 0x50, 0xFC, 0xFC, 0x50, 0x8C, 0x01, 0x00, 0x01, 0x01, 0x00, 0x01,
-	0x80, 0x80, 0xF0, 0xF0, 0x80, 0x80, 0x00, 0x00, 0x07, 0x07, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x24, 0x3C, 0x1C, 0x00,
-	0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00, 0x00,
-	0x00, 0x00, 0xC0, 0xF0, 0x3E, 0x0E, 0x38, 0x3E, 0x07, 0x01, 0x00, 0x00,
-	0xF8, 0xFC, 0x04, 0x04, 0xFC, 0xF8, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0x10, 0x18, 0xFC, 0xFC, 0x00, 0x00, 0x08, 0x08, 0x0F, 0x0F, 0x08, 0x08,
-	0x18, 0x1C, 0x04, 0xC4, 0xFC, 0x38, 0x0C, 0x0E, 0x0B, 0x09, 0x08, 0x08,
-	0x18, 0x1C, 0x44, 0x44, 0xFC, 0xB8, 0x06, 0x0E, 0x08, 0x08, 0x0F, 0x07,
-	0x80, 0xC0, 0x60, 0xF8, 0xFC, 0x00, 0x03, 0x03, 0x02, 0x0F, 0x0F, 0x02,
-	0x7C, 0x7C, 0x24, 0x24, 0xE4, 0xC4, 0x06, 0x0E, 0x08, 0x08, 0x0F, 0x07,
-	0xF0, 0xF8, 0x4C, 0x44, 0xDC, 0x98, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0x1C, 0x1C, 0xC4, 0xF4, 0x3C, 0x0C, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00,
-	0x38, 0xFC, 0xC4, 0xC4, 0xFC, 0x38, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0x78, 0xFC, 0x84, 0x84, 0xFC, 0xF8, 0x06, 0x0E, 0x08, 0x0C, 0x07, 0x03,
-	0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, 0x00, 0x06, 0x06, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x30, 0x30, 0x00, 0x00, 0x00, 0x12, 0x1E, 0x0E, 0x00,
-	0x80, 0xC0, 0x60, 0x30, 0x18, 0x08, 0x00, 0x01, 0x03, 0x06, 0x0C, 0x08,
-	0x40, 0x40, 0x40, 0x40, 0x40, 0x40, 0x02, 0x02, 0x02, 0x02, 0x02, 0x02,
-	0x08, 0x18, 0x30, 0x60, 0xC0, 0x80, 0x08, 0x0C, 0x06, 0x03, 0x01, 0x00,
-	0x18, 0x1C, 0xC4, 0xE4, 0x3C, 0x18, 0x00, 0x00, 0x0D, 0x0D, 0x00, 0x00,
-	0xF0, 0xF8, 0xEC, 0xF4, 0x1C, 0xF8, 0x03, 0x07, 0x0D, 0x0B, 0x0A, 0x0B,
-	0xF8, 0xFC, 0x0C, 0x0C, 0xFC, 0xF8, 0x0F, 0x0F, 0x01, 0x01, 0x0F, 0x0F,
-	0xFC, 0xFC, 0x44, 0x44, 0xFC, 0x98, 0x0F, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0xF8, 0xFC, 0x04, 0x04, 0x1C, 0x18, 0x07, 0x0F, 0x08, 0x08, 0x0E, 0x06,
-	0xFC, 0xFC, 0x04, 0x0C, 0xF8, 0xF0, 0x0F, 0x0F, 0x08, 0x0C, 0x07, 0x03,
-	0xFC, 0xFC, 0x44, 0x44, 0x44, 0x04, 0x0F, 0x0F, 0x08, 0x08, 0x08, 0x08,
-	0xFC, 0xFC, 0x44, 0x44, 0x44, 0x04, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
-	0xF8, 0xFC, 0x04, 0x84, 0x9C, 0x98, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0xFC, 0xFC, 0x40, 0x40, 0xFC, 0xFC, 0x0F, 0x0F, 0x00, 0x00, 0x0F, 0x0F,
-	0x04, 0x04, 0xFC, 0xFC, 0x04, 0x04, 0x08, 0x08, 0x0F, 0x0F, 0x08, 0x08,
-	0x00, 0x00, 0x00, 0x00, 0xFC, 0xFC, 0x06, 0x0E, 0x08, 0x0C, 0x07, 0x03,
-	0xFC, 0xFC, 0xF0, 0x98, 0x0C, 0x04, 0x0F, 0x0F, 0x01, 0x03, 0x0E, 0x0C,
-	0xFC, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x08, 0x08, 0x08, 0x08,
-	0xFC, 0xF8, 0x60, 0x60, 0xF8, 0xFC, 0x0F, 0x0F, 0x00, 0x00, 0x0F, 0x0F,
-	0xFC, 0xFC, 0x70, 0x80, 0xFC, 0xFC, 0x0F, 0x0F, 0x00, 0x03, 0x0F, 0x0F,
-	0xF8, 0xFC, 0x04, 0x04, 0xFC, 0xF8, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0xFC, 0xFC, 0x84, 0x84, 0xFC, 0x78, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
-	0xF8, 0xFC, 0x04, 0x04, 0xFC, 0xF8, 0x07, 0x0F, 0x09, 0x0A, 0x1F, 0x37,
-	0xFC, 0xFC, 0x44, 0xC4, 0xFC, 0x38, 0x0F, 0x0F, 0x00, 0x00, 0x0F, 0x0F,
-	0x18, 0x3C, 0xE4, 0xC4, 0x1C, 0x18, 0x06, 0x0E, 0x08, 0x09, 0x0F, 0x06,
-	0x04, 0x04, 0xFC, 0xFC, 0x04, 0x04, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00,
-	0xFC, 0xFC, 0x00, 0x00, 0xFC, 0xFC, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0xFC, 0xFC, 0x00, 0x00, 0xFC, 0xFC, 0x01, 0x07, 0x0E, 0x0E, 0x07, 0x01,
-	0xFC, 0xFC, 0x80, 0x80, 0xFC, 0xFC, 0x07, 0x0F, 0x07, 0x07, 0x0F, 0x07,
-	0x0C, 0x3C, 0xF0, 0xF0, 0x3C, 0x0C, 0x0C, 0x0F, 0x03, 0x03, 0x0F, 0x0C,
-	0x1C, 0x7C, 0xE0, 0xE0, 0x7C, 0x1C, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00,
-	0x04, 0x04, 0xC4, 0xF4, 0x3C, 0x0C, 0x0C, 0x0F, 0x0B, 0x08, 0x08, 0x08,
-	0x00, 0xFE, 0xFE, 0x02, 0x02, 0x02, 0x00, 0x3F, 0x3F, 0x20, 0x20, 0x20,
-	0x0E, 0x3E, 0xF0, 0xC0, 0x00, 0x00, 0x00, 0x00, 0x01, 0x07, 0x3E, 0x38,
-	0x00, 0x02, 0x02, 0x02, 0xFE, 0xFE, 0x00, 0x20, 0x20, 0x20, 0x3F, 0x3F,
-	0x04, 0x06, 0x03, 0x03, 0x06, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x30, 0x30, 0x30, 0x30, 0x30, 0x30,
-	0x00, 0x02, 0x06, 0x0C, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-	0x40, 0x60, 0x20, 0xA0, 0xE0, 0xC0, 0x06, 0x0F, 0x09, 0x08, 0x0F, 0x0F,
-	0xFC, 0xFC, 0x20, 0x20, 0xE0, 0xC0, 0x0F, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0xC0, 0xE0, 0x20, 0x20, 0x60, 0x40, 0x07, 0x0F, 0x08, 0x08, 0x0C, 0x04,
-	0xC0, 0xE0, 0x20, 0x20, 0xFC, 0xFC, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x0F,
-	0xC0, 0xE0, 0x20, 0x20, 0xE0, 0xC0, 0x07, 0x0F, 0x09, 0x09, 0x0D, 0x05,
-	0x40, 0x40, 0xF8, 0xFC, 0x4C, 0x48, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00,
-	0xC0, 0xE0, 0x20, 0xE0, 0xC0, 0x60, 0x19, 0x3F, 0x2A, 0x2B, 0x39, 0x10,
-	0xFC, 0xFC, 0x20, 0x20, 0xE0, 0xC0, 0x0F, 0x0F, 0x00, 0x00, 0x0F, 0x0F,
-	0x00, 0x00, 0xEC, 0xEC, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00,
-	0x00, 0x00, 0x00, 0x00, 0xEC, 0xEC, 0x00, 0x10, 0x30, 0x20, 0x3F, 0x1F,
-	0xFC, 0xFC, 0x80, 0xC0, 0x60, 0x00, 0x0F, 0x0F, 0x01, 0x03, 0x06, 0x0C,
-	0x00, 0x00, 0xFC, 0xFC, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x0F, 0x00, 0x00,
-	0xE0, 0xE0, 0xC0, 0xE0, 0xE0, 0xC0, 0x0F, 0x0F, 0x07, 0x07, 0x0F, 0x0F,
-	0xE0, 0xE0, 0x20, 0x20, 0xE0, 0xC0, 0x0F, 0x0F, 0x00, 0x00, 0x0F, 0x0F,
-	0xC0, 0xE0, 0x20, 0x20, 0xE0, 0xC0, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x07,
-	0xE0, 0xE0, 0x20, 0x20, 0xE0, 0xC0, 0x3F, 0x3F, 0x08, 0x08, 0x0F, 0x07,
-	0xC0, 0xE0, 0x20, 0x20, 0xE0, 0xE0, 0x07, 0x0F, 0x08, 0x08, 0x3F, 0x3F,
-	0xE0, 0xE0, 0x20, 0x20, 0xE0, 0xC0, 0x0F, 0x0F, 0x00, 0x00, 0x00, 0x00,
-	0x40, 0xE0, 0xA0, 0x20, 0x60, 0x40, 0x04, 0x0C, 0x09, 0x0B, 0x0E, 0x04,
-	0x20, 0x20, 0xFC, 0xFC, 0x20, 0x20, 0x00, 0x00, 0x07, 0x0F, 0x08, 0x08,
-	0xE0, 0xE0, 0x00, 0x00, 0xE0, 0xE0, 0x07, 0x0F, 0x08, 0x08, 0x0F, 0x0F,
-	0xE0, 0xE0, 0x00, 0x00, 0xE0, 0xE0, 0x00, 0x03, 0x0F, 0x0F, 0x03, 0x00,
-	0xE0, 0xE0, 0x80, 0x80, 0xE0, 0xE0, 0x07, 0x0F, 0x07, 0x07, 0x0F, 0x07,
-	0x60, 0xE0, 0x80, 0x80, 0xE0, 0x60, 0x0C, 0x0E, 0x03, 0x03, 0x0E, 0x0C,
-	0x60, 0xE0, 0x80, 0x00, 0xE0, 0xE0, 0x10, 0x31, 0x27, 0x3E, 0x1F, 0x01,
-	0x20, 0x20, 0x20, 0xA0, 0xE0, 0x60, 0x0C, 0x0E, 0x0B, 0x09, 0x08, 0x08,
-	0x00, 0x80, 0xFC, 0x7E, 0x02, 0x02, 0x00, 0x00, 0x1F, 0x3F, 0x20, 0x20,
-	0x00, 0x00, 0xFE, 0xFE, 0x00, 0x00, 0x00, 0x00, 0x3F, 0x3F, 0x00, 0x00,
-	0x00, 0x02, 0x02, 0x7E, 0xFC, 0x80, 0x00, 0x20, 0x20, 0x3F, 0x1F, 0x00,
-	0x1C, 0x06, 0x0C, 0x0C, 0x18, 0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
-	}
-};
-
-static const struct display_font_t fixed_font8 = {
-	.cheight = 1,
-	.width = 5,
-	.space = 6,
-	.symbols_count = 95,
-	.first_symbol = 32,
-	.map = {
-	0x00, 0x00, 0x00, 0x00, 0x00, // (space)
-	0x00, 0x00, 0x5F, 0x00, 0x00, // !
-	0x00, 0x07, 0x00, 0x07, 0x00, // "
-	0x14, 0x7F, 0x14, 0x7F, 0x14, // #
-	0x24, 0x2A, 0x7F, 0x2A, 0x12, // $
-	0x23, 0x13, 0x08, 0x64, 0x62, // %
-	0x36, 0x49, 0x55, 0x22, 0x50, // &
-	0x00, 0x05, 0x03, 0x00, 0x00, // '
-	0x00, 0x1C, 0x22, 0x41, 0x00, // (
-	0x00, 0x41, 0x22, 0x1C, 0x00, // )
-	0x08, 0x2A, 0x1C, 0x2A, 0x08, // *
-	0x08, 0x08, 0x3E, 0x08, 0x08, // +
-	0x00, 0x50, 0x30, 0x00, 0x00, // ,
-	0x08, 0x08, 0x08, 0x08, 0x08, // -
-	0x00, 0x60, 0x60, 0x00, 0x00, // .
-	0x20, 0x10, 0x08, 0x04, 0x02, // /
-	0x3E, 0x51, 0x49, 0x45, 0x3E, // 0
-	0x00, 0x42, 0x7F, 0x40, 0x00, // 1
-	0x42, 0x61, 0x51, 0x49, 0x46, // 2
-	0x21, 0x41, 0x45, 0x4B, 0x31, // 3
-	0x18, 0x14, 0x12, 0x7F, 0x10, // 4
-	0x27, 0x45, 0x45, 0x45, 0x39, // 5
-	0x3C, 0x4A, 0x49, 0x49, 0x30, // 6
-	0x01, 0x71, 0x09, 0x05, 0x03, // 7
-	0x36, 0x49, 0x49, 0x49, 0x36, // 8
-	0x06, 0x49, 0x49, 0x29, 0x1E, // 9
-	0x00, 0x36, 0x36, 0x00, 0x00, // :
-	0x00, 0x56, 0x36, 0x00, 0x00, // ;
-	0x00, 0x08, 0x14, 0x22, 0x41, // <
-	0x14, 0x14, 0x14, 0x14, 0x14, // =
-	0x41, 0x22, 0x14, 0x08, 0x00, // >
-	0x02, 0x01, 0x51, 0x09, 0x06, // ?
-	0x32, 0x49, 0x79, 0x41, 0x3E, // @
-	0x7E, 0x11, 0x11, 0x11, 0x7E, // A
-	0x7F, 0x49, 0x49, 0x49, 0x36, // B
-	0x3E, 0x41, 0x41, 0x41, 0x22, // C
-	0x7F, 0x41, 0x41, 0x22, 0x1C, // D
-	0x7F, 0x49, 0x49, 0x49, 0x41, // E
-	0x7F, 0x09, 0x09, 0x01, 0x01, // F
-	0x3E, 0x41, 0x41, 0x51, 0x32, // G
-	0x7F, 0x08, 0x08, 0x08, 0x7F, // H
-	0x00, 0x41, 0x7F, 0x41, 0x00, // I
-	0x20, 0x40, 0x41, 0x3F, 0x01, // J
-	0x7F, 0x08, 0x14, 0x22, 0x41, // K
-	0x7F, 0x40, 0x40, 0x40, 0x40, // L
-	0x7F, 0x02, 0x04, 0x02, 0x7F, // M
-	0x7F, 0x04, 0x08, 0x10, 0x7F, // N
-	0x3E, 0x41, 0x41, 0x41, 0x3E, // O
-	0x7F, 0x09, 0x09, 0x09, 0x06, // P
-	0x3E, 0x41, 0x51, 0x21, 0x5E, // Q
-	0x7F, 0x09, 0x19, 0x29, 0x46, // R
-	0x46, 0x49, 0x49, 0x49, 0x31, // S
-	0x01, 0x01, 0x7F, 0x01, 0x01, // T
-	0x3F, 0x40, 0x40, 0x40, 0x3F, // U
-	0x1F, 0x20, 0x40, 0x20, 0x1F, // V
-	0x7F, 0x20, 0x18, 0x20, 0x7F, // W
-	0x63, 0x14, 0x08, 0x14, 0x63, // X
-	0x03, 0x04, 0x78, 0x04, 0x03, // Y
-	0x61, 0x51, 0x49, 0x45, 0x43, // Z
-	0x00, 0x00, 0x7F, 0x41, 0x41, // [
-	0x02, 0x04, 0x08, 0x10, 0x20, // (backslash)
-	0x41, 0x41, 0x7F, 0x00, 0x00, // ]
-	0x04, 0x02, 0x01, 0x02, 0x04, // ^
-	0x40, 0x40, 0x40, 0x40, 0x40, // _
-	0x00, 0x01, 0x02, 0x04, 0x00, // `
-	0x20, 0x54, 0x54, 0x54, 0x78, // a
-	0x7F, 0x48, 0x44, 0x44, 0x38, // b
-	0x38, 0x44, 0x44, 0x44, 0x20, // c
-	0x38, 0x44, 0x44, 0x48, 0x7F, // d
-	0x38, 0x54, 0x54, 0x54, 0x18, // e
-	0x08, 0x7E, 0x09, 0x01, 0x02, // f
-	0x08, 0x14, 0x54, 0x54, 0x3C, // g
-	0x7F, 0x08, 0x04, 0x04, 0x78, // h
-	0x00, 0x44, 0x7D, 0x40, 0x00, // i
-	0x20, 0x40, 0x44, 0x3D, 0x00, // j
-	0x00, 0x7F, 0x10, 0x28, 0x44, // k
-	0x00, 0x41, 0x7F, 0x40, 0x00, // l
-	0x7C, 0x04, 0x18, 0x04, 0x78, // m
-	0x7C, 0x08, 0x04, 0x04, 0x78, // n
-	0x38, 0x44, 0x44, 0x44, 0x38, // o
-	0x7C, 0x14, 0x14, 0x14, 0x08, // p
-	0x08, 0x14, 0x14, 0x18, 0x7C, // q
-	0x7C, 0x08, 0x04, 0x04, 0x08, // r
-	0x48, 0x54, 0x54, 0x54, 0x20, // s
-	0x04, 0x3F, 0x44, 0x40, 0x20, // t
-	0x3C, 0x40, 0x40, 0x20, 0x7C, // u
-	0x1C, 0x20, 0x40, 0x20, 0x1C, // v
-	0x3C, 0x40, 0x30, 0x40, 0x3C, // w
-	0x44, 0x28, 0x10, 0x28, 0x44, // x
-	0x0C, 0x50, 0x50, 0x50, 0x3C, // y
-	0x44, 0x64, 0x54, 0x4C, 0x44, // z
-	0x00, 0x08, 0x36, 0x41, 0x00, // {
-	0x00, 0x00, 0x7F, 0x00, 0x00, // |
-	0x00, 0x41, 0x36, 0x08, 0x00, // }
-	0x0C, 0x02, 0x0C, 0x10, 0x0C  // ~
-	}
-};
+const struct display_font_t *display_font(enum display_font_id id);
+void display_font_glyph(const struct display_font_t *font, char ch, u8 *buf);
 
 #endif // __DISPLAY_FONTS_H__
@@ -4,12 +4,51 @@
 #define __DISPLAY_MODULE_H__
 
 #include "ssd1306.h"
-#include "display_fonts.h"
 
 #define MAX_STR_LEN 21
+#define DISPLAY_IMAGE_SIZE (SSD1306_SEGMENTS * SSD1306_PAGES)
+
+/* Fonts are owned by the display module */
+enum display_font_id {
+	FONT_LCD24,			/* Digits, minus and point only */
+	FONT_BOLDER16,
+	FONT_FIXED16,
+	FONT_FIXEDB16,
+	FONT_FIXED8,
+	FONT_COUNT,
+};
+
+struct display_font_info {
+	u8 cheight;			/* Pages */
+	u8 width;			/* Glyph columns */
+	u8 space;			/* Columns per symbol */
+	u8 symbols_count;
+	u8 first_symbol;
+};
+
+/* Same mapping as bc_display_print(), unknown symbols are glyph 0 */
+static inline int display_font_symbol(const struct display_font_info *font,
+				      char ch)
+{
+	if (ch > font->first_symbol &&
+	    ch < font->first_symbol + font->symbols_count)
+		return ch - font->first_symbol;
+
+	return 0;
+}
 
 extern int bc_display_clear(void);
-extern int bc_display_print(u8 offset, u8 line,
-			    const struct display_font_t *font, char *str);
+extern int bc_display_print(u8 offset, u8 line, enum display_font_id font,
+			    char *str);
+extern int bc_display_bitmap(u8 offset, u8 line, u8 width, u8 pages,
+			     const u8 *bitmap);
+extern int bc_display_image(const u8 *image);
+extern int bc_display_render(u8 *image, u8 offset, u8 line,
+			     enum display_font_id font, const char *str);
+extern int bc_display_flush(void);
+extern int bc_display_keepalive(void);
+extern u32 bc_display_epoch(void);
+extern const struct display_font_info *
+bc_display_font(enum display_font_id id);
 
 #endif // __DISPLAY_MODULE_H__
@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: GPL */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM bc_display
+
+#if !defined(__DISPLAY_TRACE_H__) || defined(TRACE_HEADER_MULTI_READ)
+#define __DISPLAY_TRACE_H__
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(display_xfer_start,
+
+	TP_PROTO(u8 offset, u8 line, int len),
+
+	TP_ARGS(offset, line, len),
+
+	TP_STRUCT__entry(
+		__field(u8, offset)
+		__field(u8, line)
+		__field(int, len)
+	),
+
+	TP_fast_assign(
+		__entry->offset = offset;
+		__entry->line = line;
+		__entry->len = len;
+	),
+
+	TP_printk("offset=%u line=%u len=%d",
+		  __entry->offset, __entry->line, __entry->len)
+);
+
+TRACE_EVENT(display_xfer_end,
+
+	TP_PROTO(u8 offset, u8 line, int ret),
+
+	TP_ARGS(offset, line, ret),
+
+	TP_STRUCT__entry(
+		__field(u8, offset)
+		__field(u8, line)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__entry->offset = offset;
+		__entry->line = line;
+		__entry->ret = ret;
+	),
+
+	TP_printk("offset=%u line=%u ret=%d",
+		  __entry->offset, __entry->line, __entry->ret)
+);
+
+TRACE_EVENT(display_power,
+
+	TP_PROTO(bool on),
+
+	TP_ARGS(on),
+
+	TP_STRUCT__entry(
+		__field(bool, on)
+	),
+
+	TP_fast_assign(
+		__entry->on = on;
+	),
+
+	TP_printk("on=%d", __entry->on)
+);
+
+#endif /* __DISPLAY_TRACE_H__ */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE display_trace
+#include <trace/define_trace.h>
@@ -0,0 +1,25 @@
+/* SPDX-License-Identifier: GPL */
+
+#ifndef __SSD1306_BUS_H__
+#define __SSD1306_BUS_H__
+
+#include <linux/types.h>
+
+#define SSD1306_CTRL_CMD	0x00	/* Control byte: commands follow */
+#define SSD1306_CTRL_DATA	0x40	/* Control byte: GDDRAM data follows */
+#define SSD1306_CTRL_CO		0x80	/* Control byte: one byte follows */
+
+/* Transfer backend: real panel on I2C or the emulator */
+struct ssd1306_bus {
+	const char *name;
+	int (*send)(const u8 *buf, int len);	/* Returns len on success */
+	void (*flush)(void);			/* End of frame, optional */
+	bool (*admit)(void);			/* Frame start, optional */
+};
+
+extern const struct ssd1306_bus ssd1306_emu_bus;
+
+int ssd1306_emu_init(void);
+void ssd1306_emu_exit(void);
+
+#endif /* __SSD1306_BUS_H__ */
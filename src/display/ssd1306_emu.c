@@ -0,0 +1,378 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/mutex.h>
+#include <linux/debugfs.h>
+#include <linux/seq_file.h>
+#include <linux/string.h>
+#include <linux/math64.h>
+
+#include "ssd1306.h"
+#include "ssd1306_bus.h"
+
+/*
+ * SSD1306 emulator: decodes the command/data stream the driver sends into
+ * a GDDRAM model and accounts the bus cost of every frame. Frames are
+ * delimited by bc_display_flush(). debugfs:
+ *   ssd1306/gddram.pbm - current GDDRAM as a 128x64 PBM, lit pixels white
+ *   ssd1306/stats      - per-frame and total counters, writing resets them
+ */
+
+#define EMU_DEBUGFS_DIR		"ssd1306"
+#define EMU_BUS_HZ		400000	/* Bus time estimate, fast mode I2C */
+#define EMU_BYTE_BITS		9	/* 8 bits and ACK */
+#define EMU_MAX_ARGS		6
+
+enum emu_addr_mode {
+	ADDR_HORIZONTAL,
+	ADDR_VERTICAL,
+	ADDR_PAGE,
+};
+
+struct emu_counters {
+	u64 transfers;
+	u64 commands;			/* Decoded opcodes */
+	u64 cmd_bytes;			/* Opcodes and their arguments */
+	u64 data_bytes;			/* GDDRAM writes */
+	u64 bus_bytes;			/* Address, control and payload */
+};
+
+static DEFINE_MUTEX(emu_lock);		/* Protects everything below */
+static u8 gddram[SSD1306_PAGES][SSD1306_SEGMENTS];
+
+static struct {
+	enum emu_addr_mode mode;
+	u8 col, col_start, col_end;
+	u8 page, page_start, page_end;
+	bool on;
+	bool inverted;
+	/* Command being assembled, arguments may come in separate transfers */
+	u8 opcode;
+	u8 args[EMU_MAX_ARGS];
+	int nargs;
+	int pending;
+} emu;
+
+static struct {
+	u32 frames;
+	struct emu_counters cur;	/* Frame in progress */
+	struct emu_counters last;	/* Last flushed frame */
+	struct emu_counters max;	/* Per-frame maximum */
+	struct emu_counters total;	/* Flushed frames */
+} stats;
+
+static struct dentry *emu_dir;
+
+static int emu_cmd_args(u8 opcode)
+{
+	switch (opcode) {
+	case SSD1306_COLUMNADDR:
+	case SSD1306_PAGEADDR:
+	case SSD1306_SET_VERTICAL_SCROLL_AREA:
+		return 2;
+	case SSD1306_RIGHT_HORIZONTAL_SCROLL:
+	case SSD1306_LEFT_HORIZONTAL_SCROLL:
+		return 6;
+	case SSD1306_VERTICAL_AND_RIGHT_HORIZONTAL_SCROLL:
+	case SSD1306_VERTICAL_AND_LEFT_HORIZONTAL_SCROLL:
+		return 5;
+	case SSD1306_SETCONTRAST:
+	case SSD1306_CHARGEPUMP:
+	case SSD1306_MEMORYMODE:
+	case SSD1306_SETMULTIPLEX:
+	case SSD1306_SETDISPLAYOFFSET:
+	case SSD1306_SETDISPLAYCLOCKDIV:
+	case SSD1306_SETPRECHARGE:
+	case SSD1306_SETCOMPINS:
+	case SSD1306_SETVCOMDETECT:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* Applies a complete command, the ones not affecting the image are dropped */
+static void emu_cmd_exec(u8 opcode, const u8 *args)
+{
+	switch (opcode) {
+	case SSD1306_MEMORYMODE:
+		emu.mode = min_t(u8, args[0] & 0x03, ADDR_PAGE);
+		break;
+	case SSD1306_COLUMNADDR:
+		emu.col_start = args[0] & (SSD1306_SEGMENTS - 1);
+		emu.col_end = args[1] & (SSD1306_SEGMENTS - 1);
+		emu.col = emu.col_start;
+		break;
+	case SSD1306_PAGEADDR:
+		emu.page_start = args[0] & (SSD1306_PAGES - 1);
+		emu.page_end = args[1] & (SSD1306_PAGES - 1);
+		emu.page = emu.page_start;
+		break;
+	case SSD1306_DISPLAYON:
+	case SSD1306_DISPLAYOFF:
+		emu.on = opcode == SSD1306_DISPLAYON;
+		break;
+	case SSD1306_NORMALDISPLAY:
+	case SSD1306_INVERTDISPLAY:
+		emu.inverted = opcode == SSD1306_INVERTDISPLAY;
+		break;
+	default:
+		/* Page addressing mode commands */
+		if (opcode < SSD1306_SETHIGHCOLUMN)
+			emu.col = (emu.col & 0xF0) | (opcode & 0x0F);
+		else if (opcode < SSD1306_SETHIGHCOLUMN + 8)
+			emu.col = (emu.col & 0x0F) | ((opcode & 0x07) << 4);
+		else if ((opcode & 0xF8) == 0xB0)
+			emu.page = opcode & 0x07;
+		break;
+	}
+}
+
+static void emu_cmd_byte(u8 byte)
+{
+	stats.cur.cmd_bytes++;
+
+	if (emu.pending) {
+		emu.args[emu.nargs++] = byte;
+		if (--emu.pending)
+			return;
+	} else {
+		stats.cur.commands++;
+		emu.opcode = byte;
+		emu.nargs = 0;
+		emu.pending = emu_cmd_args(byte);
+		if (emu.pending)
+			return;
+	}
+
+	emu_cmd_exec(emu.opcode, emu.args);
+}
+
+/* GDDRAM write and address pointer advance of the addressing mode */
+static void emu_data_byte(u8 byte)
+{
+	stats.cur.data_bytes++;
+
+	gddram[emu.page][emu.col] = byte;
+
+	switch (emu.mode) {
+	case ADDR_HORIZONTAL:
+		if (emu.col++ < emu.col_end)
+			break;
+		emu.col = emu.col_start;
+		if (emu.page++ >= emu.page_end)
+			emu.page = emu.page_start;
+		break;
+	case ADDR_VERTICAL:
+		if (emu.page++ < emu.page_end)
+			break;
+		emu.page = emu.page_start;
+		if (emu.col++ >= emu.col_end)
+			emu.col = emu.col_start;
+		break;
+	case ADDR_PAGE:
+		emu.col = (emu.col + 1) & (SSD1306_SEGMENTS - 1);
+		break;
+	}
+}
+
+/* Control byte with Co set is followed by one byte and a new control byte */
+static int emu_send(const u8 *buf, int len)
+{
+	int i = 0;
+	u8 ctrl;
+
+	if (len < 2)
+		return -EINVAL;
+
+	mutex_lock(&emu_lock);
+
+	stats.cur.transfers++;
+	stats.cur.bus_bytes += len + 1;
+
+	while (i < len) {
+		ctrl = buf[i++];
+
+		for (; i < len; i++) {
+			if (ctrl & SSD1306_CTRL_DATA)
+				emu_data_byte(buf[i]);
+			else
+				emu_cmd_byte(buf[i]);
+
+			if (ctrl & SSD1306_CTRL_CO) {
+				i++;
+				break;
+			}
+		}
+	}
+
+	mutex_unlock(&emu_lock);
+
+	return len;
+}
+
+static void emu_counters_max(struct emu_counters *max,
+			     const struct emu_counters *c)
+{
+	max->transfers = max(max->transfers, c->transfers);
+	max->commands = max(max->commands, c->commands);
+	max->cmd_bytes = max(max->cmd_bytes, c->cmd_bytes);
+	max->data_bytes = max(max->data_bytes, c->data_bytes);
+	max->bus_bytes = max(max->bus_bytes, c->bus_bytes);
+}
+
+/* Nothing sent since the last flush is not a frame */
+static void emu_flush(void)
+{
+	mutex_lock(&emu_lock);
+
+	if (stats.cur.transfers) {
+		stats.frames++;
+		stats.last = stats.cur;
+		emu_counters_max(&stats.max, &stats.cur);
+		stats.total.transfers += stats.cur.transfers;
+		stats.total.commands += stats.cur.commands;
+		stats.total.cmd_bytes += stats.cur.cmd_bytes;
+		stats.total.data_bytes += stats.cur.data_bytes;
+		stats.total.bus_bytes += stats.cur.bus_bytes;
+		memset(&stats.cur, 0, sizeof(stats.cur));
+	}
+
+	mutex_unlock(&emu_lock);
+}
+
+const struct ssd1306_bus ssd1306_emu_bus = {
+	.name = "emulated",
+	.send = emu_send,
+	.flush = emu_flush,
+};
+
+
+#pragma region /* Debugfs files */
+static int gddram_show(struct seq_file *m, void *v)
+{
+	int x, y;
+	u8 row[SSD1306_SEGMENTS / 8];
+	bool lit;
+
+	seq_printf(m, "P4\n%d %d\n", SSD1306_SEGMENTS, SSD1306_PAGES * 8);
+
+	mutex_lock(&emu_lock);
+
+	/* PBM 1 is black, the panel shows set bits lit */
+	for (y = 0; y < SSD1306_PAGES * 8; y++) {
+		memset(row, 0, sizeof(row));
+		for (x = 0; x < SSD1306_SEGMENTS; x++) {
+			lit = gddram[y / 8][x] & BIT(y % 8);
+			if (!emu.on || lit == emu.inverted)
+				row[x / 8] |= 0x80 >> (x % 8);
+		}
+		seq_write(m, row, sizeof(row));
+	}
+
+	mutex_unlock(&emu_lock);
+
+	return 0;
+}
+DEFINE_SHOW_ATTRIBUTE(gddram);
+
+static u64 emu_bus_us(u64 bytes)
+{
+	return div_u64(bytes * EMU_BYTE_BITS * USEC_PER_SEC, EMU_BUS_HZ);
+}
+
+static void stats_print(struct seq_file *m, const char *name,
+			const struct emu_counters *c)
+{
+	seq_printf(m, "%-6s transfers %llu commands %llu cmd_bytes %llu data_bytes %llu bus_bytes %llu bus_us %llu\n",
+		   name, c->transfers, c->commands, c->cmd_bytes,
+		   c->data_bytes, c->bus_bytes, emu_bus_us(c->bus_bytes));
+}
+
+static int stats_show(struct seq_file *m, void *v)
+{
+	struct emu_counters avg = {};
+
+	mutex_lock(&emu_lock);
+
+	seq_printf(m, "frames %u panel %s\n", stats.frames,
+		   emu.on ? "on" : "off");
+	stats_print(m, "last", &stats.last);
+	stats_print(m, "max", &stats.max);
+	if (stats.frames) {
+		avg.transfers = div_u64(stats.total.transfers, stats.frames);
+		avg.commands = div_u64(stats.total.commands, stats.frames);
+		avg.cmd_bytes = div_u64(stats.total.cmd_bytes, stats.frames);
+		avg.data_bytes = div_u64(stats.total.data_bytes, stats.frames);
+		avg.bus_bytes = div_u64(stats.total.bus_bytes, stats.frames);
+	}
+	stats_print(m, "avg", &avg);
+	stats_print(m, "total", &stats.total);
+
+	mutex_unlock(&emu_lock);
+
+	return 0;
+}
+
+static int stats_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, stats_show, inode->i_private);
+}
+
+/* Any write resets the counters */
+static ssize_t stats_write(struct file *file, const char __user *buf,
+			   size_t count, loff_t *ppos)
+{
+	mutex_lock(&emu_lock);
+	memset(&stats, 0, sizeof(stats));
+	mutex_unlock(&emu_lock);
+
+	return count;
+}
+
+static const struct file_operations stats_fops = {
+	.owner = THIS_MODULE,
+	.open = stats_open,
+	.read = seq_read,
+	.write = stats_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+#pragma endregion
+
+
+/**
+ * ssd1306_emu_init() - reset the emulated panel and create debugfs files
+ *
+ * Return: 0 on success. Error code on error.
+ */
+int ssd1306_emu_init(void)
+{
+	mutex_lock(&emu_lock);
+
+	/* Power-on state: display off, page addressing, whole GDDRAM */
+	memset(gddram, 0, sizeof(gddram));
+	memset(&emu, 0, sizeof(emu));
+	emu.mode = ADDR_PAGE;
+	emu.col_end = SSD1306_SEGMENTS - 1;
+	emu.page_end = SSD1306_PAGES - 1;
+	memset(&stats, 0, sizeof(stats));
+
+	mutex_unlock(&emu_lock);
+
+	emu_dir = debugfs_create_dir(EMU_DEBUGFS_DIR, NULL);
+	debugfs_create_file("gddram.pbm", 0444, emu_dir, NULL, &gddram_fops);
+	debugfs_create_file("stats", 0644, emu_dir, NULL, &stats_fops);
+
+	return 0;
+}
+
+/**
+ * ssd1306_emu_exit() - remove debugfs files of the emulated panel
+ */
+void ssd1306_emu_exit(void)
+{
+	debugfs_remove_recursive(emu_dir);
+	emu_dir = NULL;
+}
@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/types.h>
+#include <linux/kernel.h>
+#include "fxpt_math.h"
+
+/*
+ * One period of Q15 sine sampled at FXPT_FFT_SIZE points:
+ * sin_tab[k] = 32767 * sin(2 * pi * k / FXPT_FFT_SIZE)
+ * cos(k) is sin(k + FXPT_FFT_SIZE / 4)
+ */
+static const int16_t sin_tab[FXPT_FFT_SIZE] = {
+	     0,   1608,   3212,   4808,   6393,   7962,   9512,  11039,
+	 12539,  14010,  15446,  16846,  18204,  19519,  20787,  22005,
+	 23170,  24279,  25329,  26319,  27245,  28105,  28898,  29621,
+	 30273,  30852,  31356,  31785,  32137,  32412,  32609,  32728,
+	 32767,  32728,  32609,  32412,  32137,  31785,  31356,  30852,
+	 30273,  29621,  28898,  28105,  27245,  26319,  25329,  24279,
+	 23170,  22005,  20787,  19519,  18204,  16846,  15446,  14010,
+	 12539,  11039,   9512,   7962,   6393,   4808,   3212,   1608,
+	     0,  -1608,  -3212,  -4808,  -6393,  -7962,  -9512, -11039,
+	-12539, -14010, -15446, -16846, -18204, -19519, -20787, -22005,
+	-23170, -24279, -25329, -26319, -27245, -28105, -28898, -29621,
+	-30273, -30852, -31356, -31785, -32137, -32412, -32609, -32728,
+	-32767, -32728, -32609, -32412, -32137, -31785, -31356, -30852,
+	-30273, -29621, -28898, -28105, -27245, -26319, -25329, -24279,
+	-23170, -22005, -20787, -19519, -18204, -16846, -15446, -14010,
+	-12539, -11039,  -9512,  -7962,  -6393,  -4808,  -3212,  -1608,
+};
+
+#define fft_sin(k)	sin_tab[(k) & (FXPT_FFT_SIZE - 1)]
+#define fft_cos(k)	sin_tab[((k) + FXPT_FFT_SIZE / 4) & (FXPT_FFT_SIZE - 1)]
+
+static inline unsigned int bit_reverse(unsigned int v)
+{
+	unsigned int i, r = 0;
+
+	for (i = 0; i < FXPT_FFT_LOG2N; i++, v >>= 1)
+		r = (r << 1) | (v & 1);
+
+	return r;
+}
+
+/*
+ * Hann window coefficient in Q15: 0.5 - 0.5 * cos(2 * pi * n / N)
+ */
+int16_t fxpt_hann(unsigned int n)
+{
+	return (32767 - fft_cos(n)) >> 1;
+}
+
+/*
+ * In-place radix-2 decimation-in-time FFT of FXPT_FFT_SIZE points in Q15.
+ * Every butterfly stage halves its output, so the result is scaled by
+ * 1 / FXPT_FFT_SIZE and can never overflow as long as input magnitudes
+ * stay below 32767. No allocations, no floats.
+ *
+ * @param re real parts, replaced with the real parts of the spectrum
+ * @param im imaginary parts, replaced with the imaginary parts of the spectrum
+ */
+void fxpt_fft(int16_t *re, int16_t *im)
+{
+	unsigned int i, j, k, size, half, step;
+	int32_t tr, ti, wr, wi;
+
+	for (i = 0; i < FXPT_FFT_SIZE; i++) {
+		j = bit_reverse(i);
+		if (j > i) {
+			swap(re[i], re[j]);
+			swap(im[i], im[j]);
+		}
+	}
+
+	for (size = 2; size <= FXPT_FFT_SIZE; size <<= 1) {
+		half = size >> 1;
+		step = FXPT_FFT_SIZE / size;
+
+		for (i = 0; i < FXPT_FFT_SIZE; i += size) {
+			for (j = 0, k = 0; j < half; j++, k += step) {
+				const unsigned int a = i + j;
+				const unsigned int b = a + half;
+
+				wr = fft_cos(k);
+				wi = -fft_sin(k);
+
+				tr = (wr * re[b] - wi * im[b]) >> 15;
+				ti = (wr * im[b] + wi * re[b]) >> 15;
+
+				re[b] = (re[a] - tr) >> 1;
+				im[b] = (im[a] - ti) >> 1;
+				re[a] = (re[a] + tr) >> 1;
+				im[a] = (im[a] + ti) >> 1;
+			}
+		}
+	}
+}
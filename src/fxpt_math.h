@@ -7,10 +7,15 @@
 
 #define FXPT_PI	0x8000
 
+#define FXPT_FFT_LOG2N	7
+#define FXPT_FFT_SIZE	(1 << FXPT_FFT_LOG2N)
+
 #ifndef abs
 #define abs(x) ((x) < 0 ? -(x) : (x))
 #endif
 
 int16_t fxpt_atan2(const int32_t y, const int32_t x);
+int16_t fxpt_hann(unsigned int n);
+void fxpt_fft(int16_t *re, int16_t *im);
 
 #endif /* _FXPT_MATH_H_ */
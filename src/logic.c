@@ -9,389 +9,1140 @@
 #include <linux/interrupt.h>
 #include <linux/workqueue.h>
 #include <linux/math.h>
+#include <linux/math64.h>
+#include <linux/mutex.h>
+#include <linux/moduleparam.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include <linux/debugfs.h>
+#include <linux/kthread.h>
+#include <linux/sched.h>
+#include <linux/hrtimer.h>
+#include <uapi/linux/sched/types.h>
 
 #include "sensor/sensor_module.h"
 #include "display/display_module.h"
 #include "logic.h"
 #include "fxpt_math.h"
 
+#define CREATE_TRACE_POINTS
+#include "logic_trace.h"
+
 #define MP KBUILD_MODNAME ": "		/* Log Message Prefix */
 
 /* Module parameters */
 static int a_button_pin = DEFAULT_A_BUTTON_GPIO_PIN;
 static int accel_calib[3];
 static int gyro_calib[3];
+static int mount_matrix[9] = {
+	ORIENT_UNIT, 0, 0,
+	0, ORIENT_UNIT, 0,
+	0, 0, ORIENT_UNIT,
+};
+static uint calib_accel_var = CALIB_ACCEL_VAR_MAX;
+static uint calib_gyro_var = CALIB_GYRO_VAR_MAX;
+static uint spectrum_rate = SPECTRUM_DEFAULT_RATE;
+static uint idle_timeout = IDLE_DEFAULT_TIMEOUT;
+static uint park_timeout = PARK_DEFAULT_TIMEOUT;
+static uint motion_threshold = MOTION_DEFAULT_THRESHOLD;
+static uint motion_duration = MOTION_DEFAULT_DURATION;
+static int loop_rt_prio = LOOP_DEFAULT_RT_PRIO;
+static int loop_cpu = -1;
+static int mount_tolerance = MOUNT_DEFAULT_TOLERANCE;
 
 module_param(a_button_pin, int, 0);
 MODULE_PARM_DESC(a_button_pin, "Action button GPIO pin");
 
-module_param_array(accel_calib, int, NULL, 0);
+module_param_array(accel_calib, int, NULL, 0644);
 MODULE_PARM_DESC(accel_calib, "Accelerometer calibration offsets");
 
-module_param_array(gyro_calib, int, NULL, 0);
+module_param_array(gyro_calib, int, NULL, 0644);
 MODULE_PARM_DESC(gyro_calib, "Gyroscope calibration offsets");
 
-/* Work loop */
+module_param(mount_tolerance, int, 0644);
+MODULE_PARM_DESC(mount_tolerance,
+		 "Mount matrix orthonormality tolerance, 1/1000 parts, negative disables the check");
+
+/* All nine entries at once, a mounting is only valid as a whole */
+static int mount_matrix_set(const char *val, const struct kernel_param *kp)
+{
+	int i, ret = 0, m[ARRAY_SIZE(mount_matrix)];
+	char *buf, *p, *tok;
+
+	buf = kstrdup(val, GFP_KERNEL);
+	if (!buf)
+		return -ENOMEM;
+
+	p = strim(buf);
+	for (i = 0; i < ARRAY_SIZE(m) && (tok = strsep(&p, ",")); i++) {
+		ret = kstrtoint(tok, 0, &m[i]);
+		if (ret)
+			goto out;
+	}
+
+	if (i < ARRAY_SIZE(m) || p) {
+		ret = -EINVAL;
+		goto out;
+	}
+
+	ret = orient_check_mount(m, READ_ONCE(mount_tolerance));
+	if (!ret)
+		memcpy(kp->arg, m, sizeof(m));
+
+out:
+	kfree(buf);
+	return ret;
+}
+
+static int mount_matrix_get(char *buf, const struct kernel_param *kp)
+{
+	const int *m = kp->arg;
+
+	return scnprintf(buf, PAGE_SIZE, "%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+			 m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8]);
+}
+
+static const struct kernel_param_ops mount_matrix_ops = {
+	.set = mount_matrix_set,
+	.get = mount_matrix_get,
+};
+
+module_param_cb(mount_matrix, &mount_matrix_ops, mount_matrix, 0644);
+MODULE_PARM_DESC(mount_matrix,
+		 "Sensor to device axes rotation, row-major, entries -1000..1000 for -1..1");
+
+module_param(calib_accel_var, uint, 0644);
+MODULE_PARM_DESC(calib_accel_var,
+		 "Calibration stillness limit: accelerometer variance (LSB^2)");
+
+module_param(calib_gyro_var, uint, 0644);
+MODULE_PARM_DESC(calib_gyro_var,
+		 "Calibration stillness limit: gyroscope variance (LSB^2)");
+
+module_param(spectrum_rate, uint, 0644);
+MODULE_PARM_DESC(spectrum_rate,
+		 "Vibration spectrum sample rate, Hz (applied on mode switch)");
+
+module_param(idle_timeout, uint, 0644);
+MODULE_PARM_DESC(idle_timeout,
+		 "Seconds without interaction before blanking (0 - never)");
+
+module_param(park_timeout, uint, 0644);
+MODULE_PARM_DESC(park_timeout,
+		 "Seconds without motion before the loop is parked (0 - never)");
+
+module_param(motion_threshold, uint, 0644);
+MODULE_PARM_DESC(motion_threshold, "Motion detection threshold, mg");
+
+module_param(motion_duration, uint, 0644);
+MODULE_PARM_DESC(motion_duration, "Motion detection duration, ms");
+
+module_param(loop_rt_prio, int, 0444);
+MODULE_PARM_DESC(loop_rt_prio,
+		 "SCHED_FIFO priority of the loop thread (0 - system workqueue)");
+
+module_param(loop_cpu, int, 0444);
+MODULE_PARM_DESC(loop_cpu, "CPU the loop thread is bound to (-1 - any)");
+
+/* Work loop: RT thread on hrtimer deadlines, system workqueue fallback */
 static struct delayed_work work_loop;
+static struct task_struct *loop_task;
+static bool loop_rt;
+static atomic_t loop_kicked = ATOMIC_INIT(0);
+static ktime_t loop_deadline = KTIME_MAX;	/* Loop thread only */
+static ktime_t loop_next;		/* Deadline of the current run, ditto */
+
+/* Acquisition failures: total and in a row (drives loop backoff) */
+static unsigned int acq_errors;
+static unsigned int acq_failing;
+
+/* Loop timing accounting, exported via debugfs */
+static struct logic_perf perf;
+static struct dentry *debugfs_dir;
+
+/* Last user interaction, jiffies */
+static unsigned long last_activity;
+
+/* Stationary tracking: the loop is parked until the motion interrupt */
+static unsigned long last_motion;
+static s32 motion_ref[3];
+static bool parked;
+
+/* Samples acquired on the current loop iteration, oldest first */
+static struct pipe_batch acquired;
+
+/* Calibration offsets snapshot, taken once per processed batch */
+static struct calib_offsets calib;
+
+/* The batch being processed calibrated, an array per axis */
+static struct logic_batch cal;
+
+/* Latest processed sample */
+static struct sensor_data sample;
+
+/* What the rendering stage has drawn, see logic_layout.c */
+static struct layout_cache screen;
+
+/* Vibration spectrum of the high-rate accelerometer stream */
+static struct logic_spectrum spectrum;
+
+/* Oversampled stream reduced to the rate of the current mode */
+static struct logic_decim decim;
+
+/* Threshold rules and their event queue (/dev/inclinometer) */
+static struct logic_events events;
+static dev_t events_devt;
+
+/* Streaming statistics of every acquired sample */
+static struct logic_stats stats = {
+	.window = STATS_DEFAULT_WINDOW,
+};
+
+/* A window of less than two samples has no variance */
+static int stats_window_set(const char *val, const struct kernel_param *kp)
+{
+	int ret;
+	unsigned int window;
+
+	ret = kstrtouint(val, 0, &window);
+	if (ret)
+		return ret;
+
+	if (window < 2 || window > STATS_MAX_WINDOW)
+		return -EINVAL;
+
+	WRITE_ONCE(stats.window, window);
+
+	return 0;
+}
+
+static const struct kernel_param_ops stats_window_ops = {
+	.set = stats_window_set,
+	.get = param_get_uint,
+};
+
+module_param_cb(stats_window, &stats_window_ops, &stats.window, 0644);
+MODULE_PARM_DESC(stats_window,
+		 "Number of samples per statistics window (2..100000)");
+
+/* Sample stream capture and replay, debugfs files */
+static struct logic_replay replay = {
+	.realtime = true,
+};
+
+module_param_named(replay_realtime, replay.realtime, bool, 0644);
+MODULE_PARM_DESC(replay_realtime,
+		 "Replay at recorded speed (N - as fast as possible)");
+
+/* Processing and rendering stages, the work loop is the acquisition one */
+static struct logic_pipeline pipe = {
+	.process.cpu = -1,
+	.render.cpu = -1,
+};
+
+module_param_named(process_cpu, pipe.process.cpu, int, 0644);
+MODULE_PARM_DESC(process_cpu, "CPU of the processing stage (-1 - any)");
+module_param_named(render_cpu, pipe.render.cpu, int, 0644);
+MODULE_PARM_DESC(render_cpu, "CPU of the rendering stage (-1 - any)");
 
 
 #pragma region /* State & Modes */
-static int display_raw_prepare(struct logic_mode *mode);
-static int display_raw(struct logic_mode *mode);
-static int display_calib_prepare(struct logic_mode *mode);
-static int display_calib(struct logic_mode *mode);
-static int display_inclinometer_prepare(struct logic_mode *mode);
-static int display_inclinometer(struct logic_mode *mode);
-static int display_scanning_prepare(struct logic_mode *mode);
-static int display_scanning(struct logic_mode *mode);
-static int display_accel_prepare(struct logic_mode *mode);
-static int display_accel(struct logic_mode *mode);
-static int display_gyro_prepare(struct logic_mode *mode);
-static int display_gyro(struct logic_mode *mode);
+static int raw_process(struct logic_mode *mode, struct logic_frame *frame);
+static int display_raw_show(struct logic_mode *mode,
+			    const struct logic_frame *frame);
+static int display_raw(struct logic_mode *mode,
+		       const struct logic_frame *frame);
+static int calib_process(struct logic_mode *mode, struct logic_frame *frame);
+static int display_calib_show(struct logic_mode *mode,
+			      const struct logic_frame *frame);
+static int display_calib(struct logic_mode *mode,
+			 const struct logic_frame *frame);
+static int inclinometer_process(struct logic_mode *mode,
+				struct logic_frame *frame);
+static int display_inclinometer_show(struct logic_mode *mode,
+				     const struct logic_frame *frame);
+static int display_inclinometer(struct logic_mode *mode,
+				const struct logic_frame *frame);
+static int scanning_process(struct logic_mode *mode,
+			    struct logic_frame *frame);
+static int display_scanning_show(struct logic_mode *mode,
+				 const struct logic_frame *frame);
+static int display_scanning(struct logic_mode *mode,
+			    const struct logic_frame *frame);
+static int display_accel_show(struct logic_mode *mode,
+			      const struct logic_frame *frame);
+static int display_accel(struct logic_mode *mode,
+			 const struct logic_frame *frame);
+static int display_gyro_show(struct logic_mode *mode,
+			     const struct logic_frame *frame);
+static int display_gyro(struct logic_mode *mode,
+			const struct logic_frame *frame);
+static int decim_prepare(struct logic_mode *mode);
+static int decim_process(struct logic_mode *mode, struct logic_frame *frame);
+static int decim_release(struct logic_mode *mode);
+static int spectrum_prepare(struct logic_mode *mode);
+static int spectrum_process(struct logic_mode *mode,
+			    struct logic_frame *frame);
+static int display_spectrum_show(struct logic_mode *mode,
+				 const struct logic_frame *frame);
+static int display_spectrum(struct logic_mode *mode,
+			    const struct logic_frame *frame);
+static int spectrum_release(struct logic_mode *mode);
+static int acquire(struct logic_state *state);
 
 /* Modes init */
 static struct logic_mode modes[] = {
 	/* [0] - Clinometer */
 	{
 		.cycle_delay = 25,
-		.prepare = display_inclinometer_prepare,
+		.process = inclinometer_process,
+		.show = display_inclinometer_show,
 		.cycle = display_inclinometer,
 	},
 	/* [1] - Accelerometer */
 	{
 		.cycle_delay = 99,
-		.prepare = display_accel_prepare,
+		.decimation = 16,
+		.prepare = decim_prepare,
+		.process = decim_process,
+		.show = display_accel_show,
 		.cycle = display_accel,
+		.release = decim_release,
 	},
 	/* [2] - Gyroscope */
 	{
 		.cycle_delay = 50,
-		.prepare = display_gyro_prepare,
+		.decimation = 8,
+		.prepare = decim_prepare,
+		.process = decim_process,
+		.show = display_gyro_show,
 		.cycle = display_gyro,
+		.release = decim_release,
 	},
 	/* [3] - Raw Sensor Data */
 	{
 		.cycle_delay = 50,
-		.prepare = display_raw_prepare,
+		.process = raw_process,
+		.show = display_raw_show,
 		.cycle = display_raw,
 	},
 	/* [4] - Calibrated Sensor Data */
 	{
 		.cycle_delay = 50,
-		.prepare = display_calib_prepare,
+		.process = calib_process,
+		.show = display_calib_show,
 		.cycle = display_calib,
 	},
-	/* [5] - Scanning Mode  */
+	/* [5] - Vibration Spectrum */
+	{
+		.cycle_delay = 50,
+		.prepare = spectrum_prepare,
+		.process = spectrum_process,
+		.show = display_spectrum_show,
+		.cycle = display_spectrum,
+		.release = spectrum_release,
+	},
+	/* [6] - Scanning Mode (must be the last one) */
 	{
 		.cycle_delay = 100,
-		.prepare = display_scanning_prepare,
+		.process = scanning_process,
+		.show = display_scanning_show,
 		.cycle = display_scanning,
 	},
 };
 
+#define SCANNING_MODE	(ARRAY_SIZE(modes) - 1)
+
+module_param_named(accel_decimation, modes[1].decimation, int, 0644);
+MODULE_PARM_DESC(accel_decimation,
+		 "Samples per shown accelerometer value (0 - single poll, max 64)");
+module_param_named(gyro_decimation, modes[2].decimation, int, 0644);
+MODULE_PARM_DESC(gyro_decimation,
+		 "Samples per shown gyroscope value (0 - single poll, max 64)");
+
 /* State init */
 static struct logic_state state = {
 	.mode_count = ARRAY_SIZE(modes),
 	.current_mode = 0,
 	.hidden_modes = 1,
+	.pending_mode = ATOMIC_INIT(LOGIC_MODE_NONE),
+	.requests = ATOMIC_INIT(0),
+	.modes = modes,
+	.acquire = acquire,
 };
 #pragma endregion
 
 
-#pragma region /* Raw Data Mode calls */
+#pragma region /* Work loop */
+static void refresh(void);
 
-static int display_raw_prepare(struct logic_mode *mode)
+/* Runs the loop as soon as possible */
+static void loop_kick(void)
 {
-	bc_display_clear();
+	struct task_struct *task;
 
-	bc_display_print(11, 0, &fixed_font16, "Sensor Raw Data");
+	if (!READ_ONCE(loop_rt)) {
+		mod_delayed_work(system_wq, &work_loop, 0);
+		return;
+	}
 
-	bc_display_print(SM_TXT_OFFSET, 2, &fixed_font8, "Accel X :");
-	bc_display_print(SM_TXT_OFFSET, 3, &fixed_font8, "Accel Y :");
-	bc_display_print(SM_TXT_OFFSET, 4, &fixed_font8, "Accel Z :");
-	bc_display_print(SM_TXT_OFFSET, 5, &fixed_font8, "Gyro X  :");
-	bc_display_print(SM_TXT_OFFSET, 6, &fixed_font8, "Gyro Y  :");
-	bc_display_print(SM_TXT_OFFSET, 7, &fixed_font8, "Gyro Z  :");
+	/* Kicks before the thread is started are picked up by it */
+	atomic_set(&loop_kicked, 1);
+	task = READ_ONCE(loop_task);
+	if (task)
+		wake_up_process(task);
+}
+
+/*
+ * Schedules the next run, called from the loop itself. The thread keeps
+ * the cadence: a deadline follows the previous one rather than the end of
+ * the run, deadlines already passed are counted and skipped.
+ *
+ * Return: time the loop is due to run next.
+ */
+static ktime_t loop_schedule(int delay)
+{
+	ktime_t now = ktime_get(), next;
+	s64 period = (s64)delay * NSEC_PER_MSEC;
+	u64 skip;
+
+	if (!READ_ONCE(loop_rt)) {
+		schedule_delayed_work(&work_loop, msecs_to_jiffies(delay));
+		return ktime_add_ms(now, delay);
+	}
+
+	next = ktime_add_ns(loop_next, period);
+	if (!delay) {
+		next = now;
+	} else if (!ktime_after(next, now)) {
+		skip = div64_u64(ktime_sub(now, next), period) + 1;
+		next = ktime_add_ns(next, skip * period);
+		perf_overrun(&perf, skip);
+	}
+
+	loop_deadline = next;
+
+	return next;
+}
+
+static void refresh_work(struct work_struct *work)
+{
+	refresh();
+}
+
+static int refresh_thread(void *data)
+{
+	bool kicked;
+	ktime_t now;
+
+	while (!kthread_should_stop()) {
+		set_current_state(TASK_INTERRUPTIBLE);
+
+		if (kthread_should_stop()) {
+			__set_current_state(TASK_RUNNING);
+			break;
+		}
+
+		/* Not rescheduled loop sleeps until kicked */
+		if (!atomic_read(&loop_kicked)) {
+			if (loop_deadline == KTIME_MAX)
+				schedule();
+			else
+				schedule_hrtimeout_range(&loop_deadline, 0,
+							 HRTIMER_MODE_ABS);
+		}
+		__set_current_state(TASK_RUNNING);
+
+		kicked = atomic_xchg(&loop_kicked, 0);
+		now = ktime_get();
+		if (!kicked && ktime_before(now, loop_deadline))
+			continue;
+
+		/* A kick ahead of time restarts the cadence */
+		loop_next = ktime_before(now, loop_deadline) ? now : loop_deadline;
+		loop_deadline = KTIME_MAX;
+		refresh();
+	}
 
 	return 0;
 }
 
-static int display_raw(struct logic_mode *mode)
+/* Falls back to the system workqueue if the thread can't be started */
+static void loop_start(ktime_t now, int delay)
 {
-	int res;
+	int ret;
+	struct task_struct *task;
+	struct sched_attr attr = {
+		.size = sizeof(attr),
+		.sched_policy = SCHED_FIFO,
+		.sched_priority = loop_rt_prio,
+	};
 
-	struct sensor_data raw_data;
-	static char s[8];
+	if (!READ_ONCE(loop_rt))
+		goto fallback;
 
-	res = bc_poll_sensor_raw_data(&raw_data);
-	if (res < 0) {
-		pr_err(MP "cannot poll the sensor\n");
-		return res;
+	task = kthread_create(refresh_thread, NULL, "%s-loop", LOGIC_DEVICE);
+	if (IS_ERR(task)) {
+		pr_warn(MP "cannot create loop thread: %ld\n", PTR_ERR(task));
+		goto fallback;
 	}
 
-	sprintf(s, "%6d", raw_data.accel_x);
-	bc_display_print(SM_TXT_OFFSET + 60, 2, &fixed_font8, s);
+	ret = sched_setattr_nocheck(task, &attr);
+	if (ret < 0)
+		pr_warn(MP "cannot set loop thread priority: %d\n", ret);
 
-	sprintf(s, "%6d", raw_data.accel_y);
-	bc_display_print(SM_TXT_OFFSET + 60, 3, &fixed_font8, s);
+	if (loop_cpu >= 0) {
+		if (cpu_online(loop_cpu))
+			kthread_bind(task, loop_cpu);
+		else
+			pr_warn(MP "CPU %d is offline, loop thread not bound\n",
+				loop_cpu);
+	}
 
-	sprintf(s, "%6d", raw_data.accel_z);
-	bc_display_print(SM_TXT_OFFSET + 60, 4, &fixed_font8, s);
+	loop_deadline = ktime_add_ms(now, delay);
+	WRITE_ONCE(loop_task, task);
+	wake_up_process(task);
 
-	sprintf(s, "%6d", raw_data.gyro_x);
-	bc_display_print(SM_TXT_OFFSET + 60, 5, &fixed_font8, s);
+	pr_info(MP "loop thread started, SCHED_FIFO priority %d\n",
+		loop_rt_prio);
 
-	sprintf(s, "%6d", raw_data.gyro_y);
-	bc_display_print(SM_TXT_OFFSET + 60, 6, &fixed_font8, s);
+	return;
 
-	sprintf(s, "%6d", raw_data.gyro_z);
-	bc_display_print(SM_TXT_OFFSET + 60, 7, &fixed_font8, s);
+fallback:
+	WRITE_ONCE(loop_rt, false);
+	schedule_delayed_work(&work_loop, atomic_xchg(&loop_kicked, 0) ?
+			      0 : msecs_to_jiffies(delay));
+}
 
-	return 0;
+static void loop_stop(void)
+{
+	if (loop_task) {
+		kthread_stop(loop_task);
+		WRITE_ONCE(loop_task, NULL);
+	}
+
+	cancel_delayed_work_sync(&work_loop);
 }
 #pragma endregion
 
 
-#pragma region /* Calibrated Data Mode calls */
-
-static int display_calib_prepare(struct logic_mode *mode)
+/* Posts a mode request and kicks the work loop to consume it right away */
+static int request_mode(int mode)
 {
-	bc_display_clear();
+	int ret;
 
-	bc_display_print(11, 0, &fixed_font16, "Calibrated Data");
+	ret = switch_mode(&state, mode);
+	if (ret < 0)
+		return ret;
 
-	bc_display_print(SM_TXT_OFFSET, 2, &fixed_font8, "Accel X :");
-	bc_display_print(SM_TXT_OFFSET, 3, &fixed_font8, "Accel Y :");
-	bc_display_print(SM_TXT_OFFSET, 4, &fixed_font8, "Accel Z :");
-	bc_display_print(SM_TXT_OFFSET, 5, &fixed_font8, "Gyro X  :");
-	bc_display_print(SM_TXT_OFFSET, 6, &fixed_font8, "Gyro Y  :");
-	bc_display_print(SM_TXT_OFFSET, 7, &fixed_font8, "Gyro Z  :");
+	WRITE_ONCE(last_activity, jiffies);
+	loop_kick();
 
 	return 0;
 }
 
-static int display_calib(struct logic_mode *mode)
+/* Wakes the display up without changing the mode */
+static void wake_up_display(void)
+{
+	WRITE_ONCE(last_activity, jiffies);
+	loop_kick();
+}
+
+/* Motion interrupt handler: someone picked the unit up */
+static void motion_wake(void)
 {
-	int res;
+	wake_up_display();
+}
 
-	struct sensor_data raw_data;
-	static char s[8];
+/*
+ * Restarts the stationary period when acceleration moved off the reference.
+ * Processing stage.
+ */
+static void motion_track(const s32 *v)
+{
+	int i;
+	s32 thr = READ_ONCE(motion_threshold) * ACCEL_1G / 1000;
 
-	res = bc_poll_sensor_raw_data(&raw_data);
-	if (res < 0) {
-		pr_err(MP "cannot poll the sensor\n");
-		return res;
+	for (i = 0; i < ARRAY_SIZE(motion_ref); i++)
+		if (abs(v[AXIS_ACCEL_X + i] - motion_ref[i]) > thr)
+			break;
+
+	if (i == ARRAY_SIZE(motion_ref))
+		return;
+
+	for (i = 0; i < ARRAY_SIZE(motion_ref); i++)
+		motion_ref[i] = v[AXIS_ACCEL_X + i];
+	WRITE_ONCE(last_motion, jiffies);
+}
+
+/*
+ * Arms the motion interrupt once the unit has been stationary long enough.
+ * FIFO modes are never parked, the FIFO would overflow.
+ *
+ * Return: true if the loop must not be rescheduled.
+ */
+static bool motion_park(void)
+{
+	int ret;
+	unsigned long timeout = READ_ONCE(park_timeout) * HZ;
+
+	if (!timeout || state.mode->sample_rate || replay_active(&replay) ||
+	    !time_after(jiffies, READ_ONCE(last_motion) + timeout))
+		return false;
+
+	ret = bc_sensor_motion_arm(READ_ONCE(motion_threshold),
+				   READ_ONCE(motion_duration), motion_wake);
+	if (ret < 0) {
+		pr_info_once(MP "loop parking unavailable: %d\n", ret);
+		return false;
 	}
 
-	sprintf(s, "%6d", raw_data.accel_x + accel_calib[0]);
-	bc_display_print(SM_TXT_OFFSET + 60, 2, &fixed_font8, s);
+	parked = true;
+	pr_debug(MP "stationary, loop parked\n");
 
-	sprintf(s, "%6d", raw_data.accel_y + accel_calib[1]);
-	bc_display_print(SM_TXT_OFFSET + 60, 3, &fixed_font8, s);
+	return true;
+}
 
-	sprintf(s, "%6d", raw_data.accel_z + accel_calib[2]);
-	bc_display_print(SM_TXT_OFFSET + 60, 4, &fixed_font8, s);
+/* Any kick of a parked loop resumes it at full rate */
+static void motion_unpark(void)
+{
+	if (!parked)
+		return;
+
+	bc_sensor_motion_disarm();
+	parked = false;
+	WRITE_ONCE(last_motion, jiffies);
+	pr_debug(MP "loop resumed\n");
+}
 
-	sprintf(s, "%6d", raw_data.gyro_x + gyro_calib[0]);
-	bc_display_print(SM_TXT_OFFSET + 60, 5, &fixed_font8, s);
 
-	sprintf(s, "%6d", raw_data.gyro_y + gyro_calib[1]);
-	bc_display_print(SM_TXT_OFFSET + 60, 6, &fixed_font8, s);
+/* Acquisition stage: every sample goes through here */
+static int acquire(struct logic_state *state)
+{
+	int ret;
+	struct pipe_batch *b = &acquired;
+
+	b->historic = replay_active(&replay);
+
+	if (b->historic) {
+		/* Replayed samples wait for room rather than being dropped */
+		if (pipe_batch_full(&pipe))
+			return -EAGAIN;
+
+		/* Replay counts as interaction, its output is to be seen */
+		ret = replay_fetch(&replay, b->data, ARRAY_SIZE(b->data));
+		WRITE_ONCE(last_activity, jiffies);
+	} else if (state->mode->sample_rate) {
+		ret = bc_sensor_fifo_read(b->data, ARRAY_SIZE(b->data));
+	} else {
+		ret = bc_poll_sensor_raw_data(&b->data[0]);
+		if (!ret)
+			ret = 1;
+	}
+
+	if (ret == -EOVERFLOW) {
+		pr_warn_ratelimited(MP "sensor fifo overflow\n");
+	} else if (ret < 0) {
+		pr_err_ratelimited(MP "cannot poll the sensor: %d\n", ret);
+		WRITE_ONCE(acq_errors, acq_errors + 1);
+		WRITE_ONCE(acq_failing, acq_failing + 1);
+	} else {
+		WRITE_ONCE(acq_failing, 0);
+	}
 
-	sprintf(s, "%6d", raw_data.gyro_z + gyro_calib[2]);
-	bc_display_print(SM_TXT_OFFSET + 60, 7, &fixed_font8, s);
+	b->len = max(ret, 0);
+	if (b->len)
+		replay_capture(&replay, b->data, b->len);
+
+	/* A switch is handed down even without samples */
+	if (!b->len && !state->switched)
+		return ret < 0 ? ret : -EAGAIN;
+
+	b->mode = state->current_mode;
+	b->rate = state->mode->sample_rate;
+	b->switched = state->switched;
+	state->switched = false;
+
+	pipe_put_batch(&pipe, b);
+
+	return ret < 0 ? ret : 0;
+}
+
+/*
+ * Decimating modes sample the FIFO at decimation times their refresh
+ * rate. Without the FIFO they fall back to single polls, which then go
+ * through the FIR only.
+ */
+static int decim_prepare(struct logic_mode *mode)
+{
+	int rate = 0;
+
+	/* The FIFO rate and the decimator must agree on it */
+	mode->ratio = clamp(READ_ONCE(mode->decimation), 0, DECIM_MAX_RATIO);
+
+	if (mode->ratio > 0) {
+		rate = DIV_ROUND_CLOSEST(mode->ratio * MSEC_PER_SEC,
+					 mode->cycle_delay);
+		rate = bc_sensor_fifo_start(min(rate, MPU6050_GYRO_RATE));
+		if (rate < 0) {
+			pr_warn(MP "no fifo, mode is not decimated: %d\n",
+				rate);
+			rate = 0;
+		}
+	}
+
+	if (!rate)
+		mode->ratio = 1;
+
+	mode->sample_rate = rate;
 
 	return 0;
 }
-#pragma endregion
 
+/* Sets all axes of the decimated stream */
+static int decim_process(struct logic_mode *mode, struct logic_frame *frame)
+{
+	if (frame->switched)
+		decim_reset(&decim, frame->rate ? mode->ratio : 1);
 
-#pragma region /* Inclinometer Mode calls */
+	/* Nothing new at the decimated rate */
+	if (!decim_feed(&decim, &cal))
+		return 0;
+
+	memcpy(frame->value, decim.out, sizeof(frame->value));
+
+	return 1;
+}
+
+static int decim_release(struct logic_mode *mode)
+{
+	if (!mode->sample_rate)
+		return 0;
+
+	mode->sample_rate = 0;
+
+	return bc_sensor_fifo_stop();
+}
+
+
+#pragma region /* Raw Data Mode calls */
+
+#define SM_VAL_OFFSET	(SM_TXT_OFFSET + 60)
+
+/* Shared by raw and calibrated data modes, fields are in axis order */
+#define SENSOR_DATA_FIELDS						\
+	LAYOUT_FIELD(SM_VAL_OFFSET, 2, FONT_FIXED8, 6),		\
+	LAYOUT_FIELD(SM_VAL_OFFSET, 3, FONT_FIXED8, 6),		\
+	LAYOUT_FIELD(SM_VAL_OFFSET, 4, FONT_FIXED8, 6),		\
+	LAYOUT_FIELD(SM_VAL_OFFSET, 5, FONT_FIXED8, 6),		\
+	LAYOUT_FIELD(SM_VAL_OFFSET, 6, FONT_FIXED8, 6),		\
+	LAYOUT_FIELD(SM_VAL_OFFSET, 7, FONT_FIXED8, 6),		\
+	LAYOUT_LABEL(SM_TXT_OFFSET, 2, FONT_FIXED8, "Accel X :"),	\
+	LAYOUT_LABEL(SM_TXT_OFFSET, 3, FONT_FIXED8, "Accel Y :"),	\
+	LAYOUT_LABEL(SM_TXT_OFFSET, 4, FONT_FIXED8, "Accel Z :"),	\
+	LAYOUT_LABEL(SM_TXT_OFFSET, 5, FONT_FIXED8, "Gyro X  :"),	\
+	LAYOUT_LABEL(SM_TXT_OFFSET, 6, FONT_FIXED8, "Gyro Y  :"),	\
+	LAYOUT_LABEL(SM_TXT_OFFSET, 7, FONT_FIXED8, "Gyro Z  :")
+
+static const struct layout_field raw_fields[] = {
+	SENSOR_DATA_FIELDS,
+	LAYOUT_LABEL(11, 0, FONT_FIXED16, "Sensor Raw Data"),
+};
 
-static int display_inclinometer_prepare(struct logic_mode *mode)
+static const struct logic_layout raw_layout = LAYOUT(raw_fields);
+
+static int raw_process(struct logic_mode *mode, struct logic_frame *frame)
+{
+	if (!cal.len)
+		return 0;
+
+	frame->value[AXIS_ACCEL_X] = sample.accel_x;
+	frame->value[AXIS_ACCEL_Y] = sample.accel_y;
+	frame->value[AXIS_ACCEL_Z] = sample.accel_z;
+	frame->value[AXIS_GYRO_X] = sample.gyro_x;
+	frame->value[AXIS_GYRO_Y] = sample.gyro_y;
+	frame->value[AXIS_GYRO_Z] = sample.gyro_z;
+
+	return 1;
+}
+
+static int display_raw_show(struct logic_mode *mode,
+			    const struct logic_frame *frame)
+{
+	return layout_prepare(&screen, &raw_layout);
+}
+
+/* Shared with the calibrated data mode */
+static int display_raw(struct logic_mode *mode,
+		       const struct logic_frame *frame)
 {
-	bc_display_clear();
+	int i;
 
-	bc_display_print(0, 0, &bolder_font16, "INCLINOMETER");
-	bc_display_print(5, 2, &fixed_font16, "Pitch:");
-	bc_display_print(19, 5, &fixed_font16, "Yaw:");
+	for (i = 0; i < AXIS_COUNT; i++)
+		layout_number(&screen, i, frame->value[i]);
 
 	return 0;
 }
+#pragma endregion
+
+
+#pragma region /* Calibrated Data Mode calls */
+
+static const struct layout_field calib_fields[] = {
+	SENSOR_DATA_FIELDS,
+	LAYOUT_LABEL(11, 0, FONT_FIXED16, "Calibrated Data"),
+};
+
+static const struct logic_layout calib_layout = LAYOUT(calib_fields);
+
+static int calib_process(struct logic_mode *mode, struct logic_frame *frame)
+{
+	if (!cal.len)
+		return 0;
+
+	batch_sample(&cal, cal.len - 1, frame->value);
+
+	return 1;
+}
+
+static int display_calib_show(struct logic_mode *mode,
+			      const struct logic_frame *frame)
+{
+	return layout_prepare(&screen, &calib_layout);
+}
+
+static int display_calib(struct logic_mode *mode,
+			 const struct logic_frame *frame)
+{
+	return display_raw(mode, frame);
+}
+#pragma endregion
+
+
+#pragma region /* Inclinometer Mode calls */
+
+enum {
+	INCLINOMETER_PITCH,
+	INCLINOMETER_ROLL,
+};
+
+static const struct layout_field inclinometer_fields[] = {
+	[INCLINOMETER_PITCH] = LAYOUT_FIELD(55, 2, FONT_LCD24, 4),
+	[INCLINOMETER_ROLL] = LAYOUT_FIELD(55, 5, FONT_LCD24, 4),
+	LAYOUT_LABEL(0, 0, FONT_BOLDER16, "INCLINOMETER"),
+	LAYOUT_LABEL(5, 2, FONT_FIXED16, "Pitch:"),
+	LAYOUT_LABEL(12, 5, FONT_FIXED16, "Roll:"),
+};
+
+static const struct logic_layout inclinometer_layout =
+	LAYOUT(inclinometer_fields);
+
+static int display_inclinometer_show(struct logic_mode *mode,
+				     const struct logic_frame *frame)
+{
+	return layout_prepare(&screen, &inclinometer_layout);
+}
 
 /*
- * The function and macros below are implemented just for
- * my particular case and only for demonstration purposes.
- * Because sensor device (mpu6050) is oriented vertically
- * alongside the breadboard, I measure pitch and yaw
+ * Angles come from the batch, oriented by batch_orient() with the
+ * mount_matrix mounting. They are smoothed while the device isn't rotating.
  */
 
 #define MULTIP		10000
 #define K1		1000
 #define K2		(MULTIP - K1)
 
-#define comp_filter(next, prev, e)(					\
-{									\
-	if (!(e))							\
-		next = DIV_ROUND_CLOSEST(next*K1 + prev*K2, MULTIP);	\
-}									\
-)
-
 #define G_SENS		(131 * 1)	/* One degree filter sensitivity */
 
-static int display_inclinometer(struct logic_mode *mode)
+/* Centidegrees, a jump across the roll wrap-around is taken as is */
+static s32 angle_filter(s32 prev, s32 next, bool still)
 {
-	int res;
+	if (!still || abs(next - prev) > 18000)
+		return next;
 
-	static struct sensor_data raw_data;
-	static int ax, ay, az, ax_prev, ay_prev, az_prev;
-	static int gain_gx, gain_gy, gain_gz;
-	static int pitch_angle, yaw_angle;
+	return DIV_ROUND_CLOSEST(next * K1 + prev * K2, MULTIP);
+}
 
-	static char sbuf[5];
+static int inclinometer_process(struct logic_mode *mode,
+				struct logic_frame *frame)
+{
+	int i;
+	bool still;
+	static s32 pitch, roll;
+	static bool primed;
+
+	/* The first batch of a mode may be empty */
+	if (frame->switched)
+		primed = false;
+
+	if (!cal.len)
+		return 0;
+
+	if (!primed) {
+		pitch = cal.angle[ORIENT_PITCH][0];
+		roll = cal.angle[ORIENT_ROLL][0];
+		primed = true;
+	}
 
+	for (i = 0; i < cal.len; i++) {
+		still = abs(cal.axis[AXIS_GYRO_X][i]) < G_SENS &&
+			abs(cal.axis[AXIS_GYRO_Y][i]) < G_SENS &&
+			abs(cal.axis[AXIS_GYRO_Z][i]) < G_SENS;
 
-	res = bc_poll_sensor_raw_data(&raw_data);
-	if (res < 0) {
-		pr_err(MP "cannot poll the sensor\n");
-		return res;
+		pitch = angle_filter(pitch, cal.angle[ORIENT_PITCH][i], still);
+		roll = angle_filter(roll, cal.angle[ORIENT_ROLL][i], still);
 	}
 
-	ax = raw_data.accel_x + accel_calib[0];
-	ay = raw_data.accel_y + accel_calib[1];
-	az = raw_data.accel_z + accel_calib[2];
+	frame->value[INCLINOMETER_PITCH] = DIV_ROUND_CLOSEST(pitch, 100);
+	frame->value[INCLINOMETER_ROLL] = DIV_ROUND_CLOSEST(roll, 100);
+
+	return 1;
+}
+
+static int display_inclinometer(struct logic_mode *mode,
+				const struct logic_frame *frame)
+{
+	layout_number(&screen, INCLINOMETER_PITCH,
+		      frame->value[INCLINOMETER_PITCH]);
+	layout_number(&screen, INCLINOMETER_ROLL,
+		      frame->value[INCLINOMETER_ROLL]);
+
+	return 0;
+}
+#pragma endregion
+
+
+#pragma region /* Accelerometer Mode calls */
+
+/* Fields are in axis order */
+static const struct layout_field accel_fields[] = {
+	LAYOUT_FIELD(81, 2, FONT_FIXEDB16, 4),
+	LAYOUT_FIELD(81, 4, FONT_FIXEDB16, 4),
+	LAYOUT_FIELD(81, 6, FONT_FIXEDB16, 4),
+	LAYOUT_LABEL(18, 0, FONT_FIXED16, "Accelerometer"),
+	LAYOUT_LABEL(18, 2, FONT_FIXED16, "Accel X:"),
+	LAYOUT_LABEL(18, 4, FONT_FIXED16, "Accel Y:"),
+	LAYOUT_LABEL(18, 6, FONT_FIXED16, "Accel Z:"),
+};
 
-	gain_gx = (raw_data.gyro_x + gyro_calib[0]) / G_SENS;
-	gain_gy = (raw_data.gyro_y + gyro_calib[1]) / G_SENS;
-	gain_gz = (raw_data.gyro_z + gyro_calib[2]) / G_SENS;
+static const struct logic_layout accel_layout = LAYOUT(accel_fields);
 
-	comp_filter(ax, ax_prev, gain_gx);
-	ax_prev = ax;
+static int display_accel_show(struct logic_mode *mode,
+			      const struct logic_frame *frame)
+{
+	return layout_prepare(&screen, &accel_layout);
+}
 
-	comp_filter(ay, ay_prev, gain_gy);
-	ay_prev = ay;
+#define TO_G ACCEL_1G
 
-	comp_filter(az, az_prev, gain_gz);
-	az_prev = az;
+/* Display Accel Data in percentage of 1 g force */
+static int display_accel(struct logic_mode *mode,
+			 const struct logic_frame *frame)
+{
+	int ax, ay, az;
 
-	pitch_angle = DIV_ROUND_CLOSEST(fxpt_atan2(ax, az) * 180, FXPT_PI);
-	sprintf(sbuf, "%4d", pitch_angle);
-	bc_display_print(55, 2, &lcd_font24, sbuf);
+	ax = DIV_ROUND_CLOSEST(frame->value[AXIS_ACCEL_X] * 100, TO_G);
+	ay = DIV_ROUND_CLOSEST(frame->value[AXIS_ACCEL_Y] * 100, TO_G);
+	az = DIV_ROUND_CLOSEST(frame->value[AXIS_ACCEL_Z] * 100, TO_G);
 
-	yaw_angle = DIV_ROUND_CLOSEST(fxpt_atan2(ay, ax) * 180, FXPT_PI);
-	sprintf(sbuf, "%4d", yaw_angle);
-	bc_display_print(55, 5, &lcd_font24, sbuf);
+	layout_number(&screen, 0, ax);
+	layout_number(&screen, 1, ay);
+	layout_number(&screen, 2, az);
 
 	return 0;
 }
 #pragma endregion
 
 
-#pragma region /* Accelerometer Mode calls */
+#pragma region /* Gyroscope Mode calls */
+
+/* Fields are in axis order */
+static const struct layout_field gyro_fields[] = {
+	LAYOUT_FIELD(78, 2, FONT_FIXEDB16, 4),
+	LAYOUT_FIELD(78, 4, FONT_FIXEDB16, 4),
+	LAYOUT_FIELD(78, 6, FONT_FIXEDB16, 4),
+	LAYOUT_LABEL(32, 0, FONT_FIXED16, "Gyroscope"),
+	LAYOUT_LABEL(22, 2, FONT_FIXED16, "Gyro X:"),
+	LAYOUT_LABEL(22, 4, FONT_FIXED16, "Gyro Y:"),
+	LAYOUT_LABEL(22, 6, FONT_FIXED16, "Gyro Z:"),
+};
+
+static const struct logic_layout gyro_layout = LAYOUT(gyro_fields);
 
-static int display_accel_prepare(struct logic_mode *mode)
+static int display_gyro_show(struct logic_mode *mode,
+			     const struct logic_frame *frame)
 {
-	bc_display_clear();
+	return layout_prepare(&screen, &gyro_layout);
+}
 
-	bc_display_print(18, 0, &fixed_font16, "Accelerometer");
+#define TO_DEGEREE GYRO_1DPS
 
-	bc_display_print(18, 2, &fixed_font16, "Accel X:");
-	bc_display_print(18, 4, &fixed_font16, "Accel Y:");
-	bc_display_print(18, 6, &fixed_font16, "Accel Z:");
+static int display_gyro(struct logic_mode *mode,
+			const struct logic_frame *frame)
+{
+	layout_number(&screen, 0, frame->value[AXIS_GYRO_X] / TO_DEGEREE);
+	layout_number(&screen, 1, frame->value[AXIS_GYRO_Y] / TO_DEGEREE);
+	layout_number(&screen, 2, frame->value[AXIS_GYRO_Z] / TO_DEGEREE);
 
 	return 0;
 }
+#pragma endregion
 
-#define TO_G 0x4000
 
-/* Display Accel Data in percentage of 1 g force */
-static int display_accel(struct logic_mode *mode)
-{
-	int res;
+#pragma region /* Vibration Spectrum Mode calls */
 
-	struct sensor_data raw_data;
-	static int ax, ay, az;
-	static char s[5];
+#define SPECTRUM_LINE	1
+#define SPECTRUM_PAGES	(SSD1306_PAGES - SPECTRUM_LINE)
+#define SPECTRUM_BAR	(SSD1306_SEGMENTS / SPECTRUM_BINS)
 
-	res = bc_poll_sensor_raw_data(&raw_data);
-	if (res < 0) {
-		pr_err(MP "cannot poll the sensor\n");
-		return res;
-	}
+enum {
+	SPECTRUM_PEAK,
+};
+
+static const struct layout_field spectrum_fields[] = {
+	[SPECTRUM_PEAK] = LAYOUT_FIELD(56, 0, FONT_FIXED8, 10),
+	LAYOUT_LABEL(0, 0, FONT_FIXED8, "Spectrum"),
+};
 
-	ax = DIV_ROUND_CLOSEST((raw_data.accel_x + accel_calib[0]) * 100, TO_G);
-	ay = DIV_ROUND_CLOSEST((raw_data.accel_y + accel_calib[1]) * 100, TO_G);
-	az = DIV_ROUND_CLOSEST((raw_data.accel_z + accel_calib[2]) * 100, TO_G);
+static const struct logic_layout spectrum_layout = LAYOUT(spectrum_fields);
 
-	sprintf(s, "%4d", ax);
-	bc_display_print(81, 2, &fixedb_font16, s);
+static int spectrum_prepare(struct logic_mode *mode)
+{
+	int rate;
 
-	sprintf(s, "%4d", ay);
-	bc_display_print(81, 4, &fixedb_font16, s);
+	rate = bc_sensor_fifo_start(spectrum_rate);
+	if (rate < 0) {
+		mode->sample_rate = 0;
+		return rate;
+	}
 
-	sprintf(s, "%4d", az);
-	bc_display_print(81, 6, &fixedb_font16, s);
+	mode->sample_rate = rate;
 
 	return 0;
 }
-#pragma endregion
 
+static int spectrum_process(struct logic_mode *mode,
+			    struct logic_frame *frame)
+{
+	int i, k;
+	bool updated = false;
+	s32 v[AXIS_COUNT];
+	static struct spectrum_result res;
 
-#pragma region /* Gyroscope Mode calls */
+	if (!frame->rate)
+		return 0;
+
+	if (frame->switched)
+		spectrum_reset(&spectrum, frame->rate);
+
+	for (i = 0; i < cal.len; i++) {
+		batch_sample(&cal, i, v);
+		updated |= spectrum_feed(&spectrum, &v[AXIS_ACCEL_X],
+					 cal.ts[i]);
+	}
+
+	if (!updated)
+		return 0;
+
+	spectrum_get(&spectrum, &res);
+	memcpy(frame->power, res.power, sizeof(frame->power));
 
-static int display_gyro_prepare(struct logic_mode *mode)
+	/* Strongest bin of all axes together */
+	for (k = 2, i = 1; k < SPECTRUM_BINS; k++)
+		if (res.power[k] > res.power[i])
+			i = k;
+
+	frame->peak = spectrum_freq(&res, i);
+
+	return 1;
+}
+
+static int display_spectrum_show(struct logic_mode *mode,
+				 const struct logic_frame *frame)
 {
-	bc_display_clear();
+	int ret;
 
-	bc_display_print(32, 0, &fixed_font16, "Gyroscope");
+	ret = layout_prepare(&screen, &spectrum_layout);
+	if (ret < 0)
+		return ret;
 
-	bc_display_print(22, 2, &fixed_font16, "Gyro X:");
-	bc_display_print(22, 4, &fixed_font16, "Gyro Y:");
-	bc_display_print(22, 6, &fixed_font16, "Gyro Z:");
+	/* Sensor FIFO didn't start, nothing will come */
+	if (!frame->rate)
+		bc_display_print(0, 3, FONT_FIXED16, "FIFO error");
 
 	return 0;
 }
 
-#define TO_DEGEREE 131
+/* Log scale, 2 px per doubling of power */
+static int spectrum_bar(u64 power)
+{
+	return min_t(int, fls64(power) * 2, SPECTRUM_PAGES * 8);
+}
 
-static int display_gyro(struct logic_mode *mode)
+static int display_spectrum(struct logic_mode *mode,
+			    const struct logic_frame *frame)
 {
-	int res;
+	int k, h, page;
+	char s[LAYOUT_MAX_WIDTH + 1];
+	static u8 bars[SPECTRUM_PAGES][SSD1306_SEGMENTS];
 
-	struct sensor_data raw_data;
-	static char s[5];
+	snprintf(s, sizeof(s), "%5u.%u Hz", frame->peak / 10, frame->peak % 10);
+	layout_text(&screen, SPECTRUM_PEAK, s);
 
-	res = bc_poll_sensor_raw_data(&raw_data);
-	if (res < 0) {
-		pr_err(MP "cannot poll the sensor\n");
-		return res;
-	}
+	/* Bars grow from the bottom, page 0 of the bitmap is the top one */
+	for (k = 0; k < SPECTRUM_BINS; k++) {
+		h = spectrum_bar(frame->power[k]);
 
-	sprintf(s, "%4d", (raw_data.gyro_x + gyro_calib[0]) / TO_DEGEREE);
-	bc_display_print(78, 2, &fixedb_font16, s);
+		for (page = SPECTRUM_PAGES - 1; page >= 0; page--) {
+			u8 col = h >= 8 ? 0xFF : (u8)(0xFF << (8 - h));
 
-	sprintf(s, "%4d", (raw_data.gyro_y + gyro_calib[1]) / TO_DEGEREE);
-	bc_display_print(78, 4, &fixedb_font16, s);
+			h = max(h - 8, 0);
+			memset(&bars[page][k * SPECTRUM_BAR], col,
+			       SPECTRUM_BAR - 1);
+			bars[page][(k + 1) * SPECTRUM_BAR - 1] = 0;
+		}
+	}
 
-	sprintf(s, "%4d", (raw_data.gyro_z + gyro_calib[2]) / TO_DEGEREE);
-	bc_display_print(78, 6, &fixedb_font16, s);
+	return bc_display_bitmap(0, SPECTRUM_LINE, SSD1306_SEGMENTS,
+				 SPECTRUM_PAGES, &bars[0][0]);
+}
 
-	return 0;
+static int spectrum_release(struct logic_mode *mode)
+{
+	mode->sample_rate = 0;
+
+	return bc_sensor_fifo_stop();
 }
 #pragma endregion
 
 
 #pragma region /* Scanning Mode (Hidden) calls */
-static int display_scanning_prepare(struct logic_mode *mode)
-{
-	bc_display_clear();
+enum {
+	SCANNING_DOTS,
+};
 
-	bc_display_print(25, 3, &fixed_font16, "Scanning");
+static const struct layout_field scanning_fields[] = {
+	[SCANNING_DOTS] = LAYOUT_FIELD(81, 3, FONT_FIXED16, 4),
+	LAYOUT_LABEL(25, 3, FONT_FIXED16, "Scanning"),
+};
 
-	return 0;
+static const struct logic_layout scanning_layout = LAYOUT(scanning_fields);
+
+/* Animated at the loop rate */
+static int scanning_process(struct logic_mode *mode,
+			    struct logic_frame *frame)
+{
+	return cal.len > 0;
+}
+
+static int display_scanning_show(struct logic_mode *mode,
+				 const struct logic_frame *frame)
+{
+	return layout_prepare(&screen, &scanning_layout);
 }
 
-static int display_scanning(struct logic_mode *mode)
+static int display_scanning(struct logic_mode *mode,
+			    const struct logic_frame *frame)
 {
 	static const char * const frames[] = {
 		"    ", ".   ", "..  ", "... ", "....", " ...", "  ..", "   ."
@@ -399,7 +1150,7 @@ static int display_scanning(struct logic_mode *mode)
 	static const size_t last = ARRAY_SIZE(frames) - 1;
 	static int pos;
 
-	bc_display_print(81, 3, &fixed_font16, (char *)frames[pos]);
+	layout_text(&screen, SCANNING_DOTS, frames[pos]);
 	pos = (pos >= last) ? 0 : pos + 1;
 
 	return 0;
@@ -407,74 +1158,201 @@ static int display_scanning(struct logic_mode *mode)
 #pragma endregion
 
 
+#pragma region /* Calibration job */
+
+enum calib_status {
+	CALIB_IDLE,
+	CALIB_RUNNING,
+	CALIB_DONE,
+	CALIB_FAILED,
+};
+
+static const char * const calib_status_names[] = {
+	[CALIB_IDLE] = "idle",
+	[CALIB_RUNNING] = "running",
+	[CALIB_DONE] = "done",
+	[CALIB_FAILED] = "failed",
+};
+
+static struct {
+	struct work_struct work;
+	struct mutex lock;		/* Protects everything below */
+	enum calib_status status;
+	int samples;
+	int error;
+	struct calib_result res;
+} calib_job;
+
+static void calib_get(struct calib_offsets *offsets)
+{
+	int i;
+
+	/* Same lock as the params sysfs writes, so offsets never tear */
+	kernel_param_lock(THIS_MODULE);
+	for (i = 0; i < 3; i++) {
+		offsets->accel[i] = accel_calib[i];
+		offsets->gyro[i] = gyro_calib[i];
+	}
+	kernel_param_unlock(THIS_MODULE);
+}
+
+/* Precomputes the mount rotation once the parameter has changed */
+static void mount_update(void)
+{
+	static int applied[ARRAY_SIZE(mount_matrix)];
+	int m[ARRAY_SIZE(mount_matrix)];
+
+	kernel_param_lock(THIS_MODULE);
+	memcpy(m, mount_matrix, sizeof(m));
+	kernel_param_unlock(THIS_MODULE);
+
+	if (!memcmp(m, applied, sizeof(m)))
+		return;
+
+	orient_set_mount(m);
+	memcpy(applied, m, sizeof(m));
+}
+
+static void calib_commit(const struct calib_offsets *offsets)
+{
+	int i;
+
+	kernel_param_lock(THIS_MODULE);
+	for (i = 0; i < 3; i++) {
+		accel_calib[i] = offsets->accel[i];
+		gyro_calib[i] = offsets->gyro[i];
+	}
+	kernel_param_unlock(THIS_MODULE);
+}
+
+static void calib_work_fn(struct work_struct *work)
+{
+	int ret, mode, requests;
+	struct calib_result res = { 0 };
+
+	mode = READ_ONCE(state.current_mode);
+	requests = atomic_read(&state.requests) + 1;
+	request_mode(SCANNING_MODE);
+
+	ret = calib_collect(calib_job.samples, READ_ONCE(calib_accel_var),
+			    READ_ONCE(calib_gyro_var), &res);
+	if (!ret)
+		calib_commit(&res.offsets);
+
+	/* A mode picked while calibrating wins over the saved one */
+	if (atomic_read(&state.requests) == requests)
+		request_mode(mode);
+
+	mutex_lock(&calib_job.lock);
+	calib_job.res = res;
+	calib_job.error = ret;
+	calib_job.status = ret ? CALIB_FAILED : CALIB_DONE;
+	mutex_unlock(&calib_job.lock);
+
+	if (ret)
+		pr_warn(MP "calibration failed: %d\n", ret);
+	else
+		pr_info(MP "calibration done, offsets committed\n");
+}
+#pragma endregion
+
+
 #pragma region /* Sysfs interface */
 static ssize_t
 accel_x_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
+	int ret;
 	s16 val;
 
-	bc_poll_sensor_raw_value(&val, accel_x);
+	ret = bc_poll_sensor_raw_value(&val, accel_x);
+	if (ret < 0)
+		return ret;
+
 	return snprintf(buf, PAGE_SIZE, "%d\n", val);
 }
 
 static ssize_t
 accel_y_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
+	int ret;
 	s16 val;
 
-	bc_poll_sensor_raw_value(&val, accel_y);
+	ret = bc_poll_sensor_raw_value(&val, accel_y);
+	if (ret < 0)
+		return ret;
+
 	return snprintf(buf, PAGE_SIZE, "%d\n", val);
 }
 
 static ssize_t
 accel_z_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
+	int ret;
 	s16 val;
 
-	bc_poll_sensor_raw_value(&val, accel_z);
+	ret = bc_poll_sensor_raw_value(&val, accel_z);
+	if (ret < 0)
+		return ret;
+
 	return snprintf(buf, PAGE_SIZE, "%d\n", val);
 }
 
 static ssize_t
 gyro_x_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
+	int ret;
 	s16 val;
 
-	bc_poll_sensor_raw_value(&val, gyro_x);
+	ret = bc_poll_sensor_raw_value(&val, gyro_x);
+	if (ret < 0)
+		return ret;
+
 	return snprintf(buf, PAGE_SIZE, "%d\n", val);
 }
 
 static ssize_t
 gyro_y_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
+	int ret;
 	s16 val;
 
-	bc_poll_sensor_raw_value(&val, gyro_y);
+	ret = bc_poll_sensor_raw_value(&val, gyro_y);
+	if (ret < 0)
+		return ret;
+
 	return snprintf(buf, PAGE_SIZE, "%d\n", val);
 }
 
 static ssize_t
 gyro_z_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
+	int ret;
 	s16 val;
 
-	bc_poll_sensor_raw_value(&val, gyro_z);
+	ret = bc_poll_sensor_raw_value(&val, gyro_z);
+	if (ret < 0)
+		return ret;
+
 	return snprintf(buf, PAGE_SIZE, "%d\n", val);
 }
 
 static ssize_t
 temp_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
+	int ret;
 	s16 val;
 
-	bc_poll_sensor_temperature(&val);
+	ret = bc_poll_sensor_temperature(&val);
+	if (ret < 0)
+		return ret;
+
 	return snprintf(buf, PAGE_SIZE, "%d\n", val);
 }
 
 static ssize_t
 mode_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
 {
-	return sprintf(buf, "%d\n", state.current_mode);
+	return sprintf(buf, "%d\n", READ_ONCE(state.current_mode));
 }
 
 static ssize_t
@@ -486,12 +1364,189 @@ mode_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf,
 	if (kstrtou8(buf, 0, &mode) < 0 || mode > state.mode_count-1)
 		return -EPERM;
 
-	state.current_mode = mode;
-	switch_mode(&state, &modes[state.current_mode]);
+	request_mode(mode);
 
 	return count;
 }
 
+static ssize_t
+calibrate_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	int i, len;
+	static const char * const names[] = {
+		"accel_x", "accel_y", "accel_z", "gyro_x", "gyro_y", "gyro_z"
+	};
+
+	mutex_lock(&calib_job.lock);
+
+	len = sysfs_emit(buf, "status: %s\n",
+			 calib_status_names[calib_job.status]);
+
+	if (calib_job.status == CALIB_FAILED)
+		len += sysfs_emit_at(buf, len, "error: %d%s\n", calib_job.error,
+				     calib_job.error == -EAGAIN ?
+				     " (device is not still)" : "");
+
+	if (calib_job.status == CALIB_DONE ||
+	    (calib_job.status == CALIB_FAILED && calib_job.res.samples)) {
+		len += sysfs_emit_at(buf, len, "samples: %d\n",
+				     calib_job.res.samples);
+		len += sysfs_emit_at(buf, len, "%-8s %7s %9s %7s\n",
+				     "axis", "mean", "variance", "offset");
+
+		for (i = 0; i < AXIS_COUNT; i++)
+			len += sysfs_emit_at(buf, len, "%-8s %7d %9u %7d\n",
+				names[i], calib_job.res.mean[i],
+				calib_job.res.var[i], i < AXIS_GYRO_X ?
+				calib_job.res.offsets.accel[i] :
+				calib_job.res.offsets.gyro[i - AXIS_GYRO_X]);
+	}
+
+	mutex_unlock(&calib_job.lock);
+
+	return len;
+}
+
+static ssize_t
+calibrate_store(struct kobject *kobj, struct kobj_attribute *attr,
+		const char *buf, size_t count)
+{
+	int samples;
+
+	if (kstrtoint(buf, 0, &samples) < 0)
+		return -EINVAL;
+
+	if (!samples)
+		samples = CALIB_DEFAULT_SAMPLES;
+
+	if (samples < 0 || samples > CALIB_MAX_SAMPLES)
+		return -EINVAL;
+
+	mutex_lock(&calib_job.lock);
+	if (calib_job.status == CALIB_RUNNING) {
+		mutex_unlock(&calib_job.lock);
+		return -EBUSY;
+	}
+	calib_job.status = CALIB_RUNNING;
+	calib_job.samples = samples;
+	calib_job.res.samples = 0;
+	mutex_unlock(&calib_job.lock);
+
+	schedule_work(&calib_job.work);
+
+	return count;
+}
+
+static ssize_t
+stats_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	return stats_print(&stats, buf, PAGE_SIZE);
+}
+
+static ssize_t
+stats_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf,
+	    size_t count)
+{
+	bool reset;
+
+	if (!sysfs_streq(buf, "reset") &&
+	    (kstrtobool(buf, &reset) < 0 || !reset))
+		return -EINVAL;
+
+	stats_reset(&stats);
+
+	return count;
+}
+
+static ssize_t
+spectrum_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	return spectrum_print(&spectrum, buf, PAGE_SIZE);
+}
+
+static const char * const health_names[] = {
+	[SENSOR_OK] = "ok",
+	[SENSOR_RECOVERING] = "recovering",
+	[SENSOR_FAILED] = "failed",
+};
+
+static ssize_t
+health_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	struct sensor_health h;
+
+	bc_sensor_health(&h);
+
+	return snprintf(buf, PAGE_SIZE,
+			"sensor: %s\nerrors: %u\nretries: %u\nreinits: %u\n"
+			"failures: %u\nlast_error: %d\n"
+			"acquire_errors: %u\nacquire_failing: %u\n",
+			health_names[h.state], h.errors, h.retries, h.reinits,
+			h.failures, h.last_error, READ_ONCE(acq_errors),
+			READ_ONCE(acq_failing));
+}
+
+static ssize_t
+clock_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	struct sensor_clock c;
+
+	bc_sensor_fifo_clock(&c);
+
+	if (!c.active)
+		return snprintf(buf, PAGE_SIZE, "fifo: off\n");
+
+	return snprintf(buf, PAGE_SIZE,
+			"rate: %u.%03u Hz\nnominal: %u Hz\ndrift: %d ppm\n"
+			"frames: %llu\nresets: %u\n",
+			c.rate / 1000, c.rate % 1000, c.nominal, c.drift,
+			c.frames, c.resets);
+}
+
+static ssize_t
+events_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	return events_print(&events, buf, PAGE_SIZE);
+}
+
+static ssize_t
+rules_show(struct kobject *kobj, struct kobj_attribute *attr, char *buf)
+{
+	return events_rules_print(&events, buf, PAGE_SIZE);
+}
+
+static ssize_t
+rules_store(struct kobject *kobj, struct kobj_attribute *attr, const char *buf,
+	    size_t count)
+{
+	int ret;
+
+	ret = events_rules_parse(&events, buf);
+
+	return ret < 0 ? ret : count;
+}
+
+static ssize_t
+sample_read(struct file *file, struct kobject *kobj, struct bin_attribute *attr,
+	    char *buf, loff_t off, size_t count)
+{
+	int ret;
+	struct sensor_data data;
+	struct logic_sample_record rec;
+
+	/* Every read from the start is a new sample, there is no tail */
+	if (off)
+		return 0;
+
+	ret = bc_poll_sensor_raw_data(&data);
+	if (ret < 0)
+		return ret;
+
+	sample_record_pack(&data, &rec);
+
+	return memory_read_from_buffer(buf, count, &off, &rec, sizeof(rec));
+}
+
 static struct kobj_attribute accel_x_attr =
 	__ATTR(ACCEL_X_SYSFS_ATTR, 0444, accel_x_show, NULL);
 static struct kobj_attribute accel_y_attr =
@@ -512,16 +1567,54 @@ static struct kobj_attribute temp_attr =
 static struct kobj_attribute mode_attr =
 	__ATTR(MODE_SYSFS_ATTR, 0664, mode_show, mode_store);
 
+static struct kobj_attribute calibrate_attr =
+	__ATTR(CALIBRATE_SYSFS_ATTR, 0664, calibrate_show, calibrate_store);
+
+static struct kobj_attribute stats_attr =
+	__ATTR(STATS_SYSFS_ATTR, 0664, stats_show, stats_store);
+
+static struct kobj_attribute spectrum_attr =
+	__ATTR(SPECTRUM_SYSFS_ATTR, 0444, spectrum_show, NULL);
+
+static struct kobj_attribute health_attr =
+	__ATTR(HEALTH_SYSFS_ATTR, 0444, health_show, NULL);
+
+static struct kobj_attribute clock_attr =
+	__ATTR(CLOCK_SYSFS_ATTR, 0444, clock_show, NULL);
+
+static struct kobj_attribute events_attr =
+	__ATTR(EVENTS_SYSFS_ATTR, 0444, events_show, NULL);
+
+static struct kobj_attribute rules_attr =
+	__ATTR(RULES_SYSFS_ATTR, 0664, rules_show, rules_store);
+
 static struct attribute *attrs[] = {
 	&accel_x_attr.attr, &accel_y_attr.attr, &accel_z_attr.attr,
 	&gyro_x_attr.attr, &gyro_y_attr.attr, &gyro_z_attr.attr,
 	&temp_attr.attr,
 	&mode_attr.attr,
+	&calibrate_attr.attr,
+	&stats_attr.attr,
+	&spectrum_attr.attr,
+	&events_attr.attr,
+	&rules_attr.attr,
+	&health_attr.attr,
+	&clock_attr.attr,
+	NULL,
+};
+
+static struct bin_attribute sample_attr =
+	__BIN_ATTR(SAMPLE_SYSFS_ATTR, 0444, sample_read, NULL,
+		   sizeof(struct logic_sample_record));
+
+static struct bin_attribute *bin_attrs[] = {
+	&sample_attr,
 	NULL,
 };
 
 static struct attribute_group attr_group = {
 	.attrs = attrs,
+	.bin_attrs = bin_attrs,
 };
 #pragma endregion
 
@@ -530,30 +1623,184 @@ static struct attribute_group attr_group = {
 static irqreturn_t a_button_isr(int irq, void *dev_id)
 {
 	static unsigned long timestamp;
+	bool accepted = jiffies - timestamp > BUTTON_DEBOUNCE_COOLDOWN;
+
+	trace_logic_button_irq(irq, accepted);
 
-	if (jiffies - timestamp > BUTTON_DEBOUNCE_COOLDOWN) {
+	if (accepted) {
 		/* It's a light call. There's no need to schedule bottom half */
-		/* All heavy work will be done on the next work loop */
-		switch_mode(&state, &modes[next_mode(&state)]);
+		/* All heavy work will be done by the immediately kicked loop */
+		/* The first press after idle only turns the display on */
+		if (READ_ONCE(state.idle))
+			wake_up_display();
+		else
+			request_mode(next_mode(&state));
 		timestamp = jiffies;
 	}
 
 	return IRQ_HANDLED;
 }
 
-/* Magic loop */
-static void refresh(struct work_struct *work)
+/* Processing stage: calibration, angles, statistics, rules, mode values */
+static void process_batch(const struct pipe_batch *in)
+{
+	int i, a;
+	s32 v[AXIS_COUNT], angle[ORIENT_COUNT];
+	struct logic_mode *mode = &modes[in->mode];
+	static struct logic_frame out;
+	static int last_mode = LOGIC_MODE_NONE, last_rate;
+
+	calib_get(&calib);
+	mount_update();
+
+	batch_calibrate(&cal, in->data, in->len, &calib);
+	batch_orient(&cal);
+
+	for (i = 0; i < cal.len; i++) {
+		batch_sample(&cal, i, v);
+		for (a = 0; a < ORIENT_COUNT; a++)
+			angle[a] = cal.angle[a][i];
+
+		stats_update(&stats, v, cal.ts[i]);
+		/* Sampling instant, recorded one for replayed samples */
+		events_process(&events, v, angle, in->data[i].timestamp);
+		motion_track(v);
+	}
+
+	if (cal.len)
+		sample = in->data[cal.len - 1];
+
+	/* The first batch of a mode may have been dropped */
+	out.mode = in->mode;
+	out.rate = in->rate;
+	out.switched = in->switched || in->mode != last_mode ||
+		       in->rate != last_rate;
+	out.historic = in->historic;
+	out.timestamp = sample.timestamp;
+	last_mode = in->mode;
+	last_rate = in->rate;
+
+	out.update = mode->process(mode, &out) > 0;
+	if (out.update || out.switched)
+		pipe_put_frame(&pipe, &out);
+}
+
+static void process_work(struct work_struct *work)
 {
-	int res;
+	ktime_t start;
+	static struct pipe_batch in;
+
+	while (pipe_get_batch(&pipe, &in)) {
+		start = ktime_get();
+		process_batch(&in);
+		perf_stage(&perf, in.mode, PERF_PROCESS, start, ktime_get());
+	}
+
+	pipe_retry_frame(&pipe);
+}
+
+/* Rendering stage: the only one that draws */
+static void render_frame(const struct logic_frame *frame)
+{
+	int ret;
+	s64 latency;
+	bool switched;
+	u32 epoch = bc_display_epoch();
+	struct logic_mode *mode = &modes[frame->mode];
+	static int drawn = LOGIC_MODE_NONE;
+	static u32 drawn_epoch;
+
+	/* A resumed display comes back blank */
+	switched = frame->switched || frame->mode != drawn ||
+		   epoch != drawn_epoch;
+	if (switched) {
+		mode->show(mode, frame);
+		drawn = frame->mode;
+		drawn_epoch = epoch;
+	}
+
+	/*
+	 * An idle unit leaves the display to blank itself. An active one keeps
+	 * it on even if the reading is steady and no cell has to be redrawn.
+	 */
+	if (!READ_ONCE(state.idle)) {
+		bc_display_keepalive();
+
+		if (frame->update) {
+			trace_logic_cycle_enter(frame->mode);
+			ret = mode->cycle(mode, frame);
+			trace_logic_cycle_exit(frame->mode, ret);
+		}
+	}
+
+	/* Whatever was drawn for the frame is one display frame */
+	if (bc_display_flush() <= 0)
+		return;
+
+	/* Cycle frames show the latest sample, replayed ones are historic */
+	if (!switched && !frame->historic) {
+		latency = ktime_us_delta(ktime_get(), frame->timestamp);
+		trace_logic_latency(frame->mode, latency);
+		perf_latency(&perf, frame->mode, latency);
+	}
+}
+
+static void render_work(struct work_struct *work)
+{
+	ktime_t start;
+	static struct logic_frame frame;
+
+	while (pipe_get_frame(&pipe, &frame)) {
+		start = ktime_get();
+		render_frame(&frame);
+		perf_stage(&perf, frame.mode, PERF_RENDER, start, ktime_get());
+	}
+}
+
+/* Magic loop, the acquisition stage */
+static void refresh(void)
+{
+	int res, delay;
+	unsigned long timeout = READ_ONCE(idle_timeout) * HZ;
+	const struct logic_mode *prev = state.mode;
+	ktime_t start = ktime_get();
+
+	motion_unpark();
+
+	WRITE_ONCE(state.idle, timeout &&
+		   time_after(jiffies, READ_ONCE(last_activity) + timeout));
 
 	res = process_state(&state);
 	if (res < 0) {
-		pr_err(MP "uh oh! something is wrong with processing state!\n");
+		/* Never give up, the next mode request may fix the state */
+		pr_err_ratelimited(MP "uh oh! something is wrong with processing state!\n");
+		perf_expect(&perf, loop_schedule(LOOP_MAX_BACKOFF),
+			    LOOP_MAX_BACKOFF);
 		return;
 	}
 
-	schedule_delayed_work(&work_loop,
-			      msecs_to_jiffies(state.mode->cycle_delay));
+	perf_account(&perf, state.current_mode, state.mode != prev, start,
+		     ktime_get());
+
+	if (motion_park()) {
+		perf_expect(&perf, KTIME_MAX, 0);
+		return;
+	}
+
+	/* FIFO modes must be drained in time even when idle */
+	delay = state.mode->cycle_delay;
+	if (state.idle && !state.mode->sample_rate)
+		delay = max(delay, IDLE_CYCLE_DELAY);
+
+	/* Sensor retries on its own, don't hammer a broken bus */
+	if (acq_failing)
+		delay = min(delay << min(acq_failing, 10U), LOOP_MAX_BACKOFF);
+
+	/* Unpaced replay runs back to back while the pipeline takes it */
+	if (replay_pending(&replay))
+		delay = pipe_batch_full(&pipe) ? 1 : 0;
+
+	perf_expect(&perf, loop_schedule(delay), delay);
 }
 
 
@@ -563,22 +1810,47 @@ static struct device *module_device;
 static int __init logic_mod_init(void)
 {
 	int ret;
+	ktime_t now;
 
 	pr_info(MP "initialization...\n");
 
+	/* Work loop must be ready before anyone can request a mode */
+	INIT_DELAYED_WORK(&work_loop, refresh_work);
+	pipe_init(&pipe, process_work, render_work);
+	loop_rt = loop_rt_prio > 0;
+	last_activity = jiffies;
+	last_motion = jiffies;
+	INIT_WORK(&calib_job.work, calib_work_fn);
+	mutex_init(&calib_job.lock);
+	stats_init(&stats, stats.window);
+	spectrum_init(&spectrum);
+
+	ret = perf_init(&perf, ARRAY_SIZE(modes));
+	if (ret < 0)
+		return ret;
+
 	/* Creating device class */
 	module_class = class_create(THIS_MODULE, LOGIC_CLASS);
 	if (IS_ERR(module_class)) {
 		pr_err(MP "cannot create device class\n");
-		return PTR_ERR(module_class);
+		ret = PTR_ERR(module_class);
+		goto r_perf;
+	}
+
+	/* Allocating events character device number */
+	ret = alloc_chrdev_region(&events_devt, 0, 1, LOGIC_DEVICE);
+	if (ret < 0) {
+		pr_err(MP "cannot allocate device number\n");
+		goto r_class;
 	}
 
 	/* Creating device */
-	module_device = device_create(module_class, NULL, 0, NULL, LOGIC_DEVICE);
+	module_device = device_create(module_class, NULL, events_devt, NULL,
+				      LOGIC_DEVICE);
 	if (IS_ERR(module_device)) {
 		pr_err(MP "cannot create device\n");
 		ret = PTR_ERR(module_device);
-		goto r_class;
+		goto r_devt;
 	}
 
 	/* Creating kobject */
@@ -588,6 +1860,7 @@ static int __init logic_mod_init(void)
 		ret = -ENOMEM;
 		goto r_dev;
 	}
+	events_init(&events, state.kobj);
 
 	/* Creating sysfs group */
 	ret = sysfs_create_group(state.kobj, &attr_group);
@@ -598,11 +1871,20 @@ static int __init logic_mod_init(void)
 	pr_info(MP "sysfs attributes created at /sys/class/%s/%s/%s\n",
 		LOGIC_CLASS, LOGIC_DEVICE, state.kobj->name);
 
+	/* Events character device */
+	cdev_init(&events.cdev, &events_fops);
+	events.cdev.owner = THIS_MODULE;
+	ret = cdev_add(&events.cdev, events_devt, 1);
+	if (ret < 0) {
+		pr_err(MP "cannot add events character device\n");
+		goto r_sysfs;
+	}
+
 	/* Checking validity of GPIO pin */
 	if (!gpio_is_valid(a_button_pin)) {
 		ret = -EIO;
 		pr_err(MP "GPIO %d is not valid\n", a_button_pin);
-		goto r_sysfs;
+		goto r_cdev;
 	}
 
 	/* Request access to the GPIO pin */
@@ -610,7 +1892,7 @@ static int __init logic_mod_init(void)
 	if (ret < 0) {
 		pr_err(MP "failed to request GPIO pin %d: %d\n",
 		       a_button_pin, ret);
-		goto r_sysfs;
+		goto r_cdev;
 	}
 
 	/* Set the GPIO pin as an input with a pull-up resistor */
@@ -634,15 +1916,32 @@ static int __init logic_mod_init(void)
 
 	/* Switching Mode */
 	pr_info(MP "number of modes: %d\n", state.mode_count);
-	ret = switch_mode(&state, &modes[state.current_mode]);
+	ret = switch_mode(&state, state.current_mode);
 	if (ret < 0) {
 		pr_err(MP "cannot switch mode\n");
 		goto r_irq;
 	}
 
+	/* Timing statistics, decode benchmark, stream capture and replay */
+	replay_init(&replay, loop_kick);
+	debugfs_dir = debugfs_create_dir(LOGIC_DEVICE, NULL);
+	debugfs_create_file(PERF_DEBUGFS_FILE, 0644, debugfs_dir, &perf,
+			    &perf_fops);
+	debugfs_create_file(LATENCY_DEBUGFS_FILE, 0644, debugfs_dir, &perf,
+			    &latency_fops);
+	debugfs_create_file(PIPELINE_DEBUGFS_FILE, 0444, debugfs_dir, &pipe,
+			    &pipeline_fops);
+	debugfs_create_file(DECODE_DEBUGFS_FILE, 0444, debugfs_dir, NULL,
+			    &decode_fops);
+	debugfs_create_file(CAPTURE_DEBUGFS_FILE, 0400, debugfs_dir, &replay,
+			    &capture_fops);
+	debugfs_create_file(REPLAY_DEBUGFS_FILE, 0200, debugfs_dir, &replay,
+			    &replay_fops);
+
 	/* Scheduling refresh loop */
-	INIT_DELAYED_WORK(&work_loop, refresh);
-	schedule_delayed_work(&work_loop, msecs_to_jiffies(INIT_DELAY));
+	now = ktime_get();
+	perf_expect(&perf, ktime_add_ms(now, INIT_DELAY), INIT_DELAY);
+	loop_start(now, INIT_DELAY);
 
 	pr_info(MP "initialization successful\n");
 
@@ -652,32 +1951,60 @@ r_irq:
 	free_irq(gpio_to_irq(a_button_pin), NULL);
 r_gpio:
 	gpio_free(a_button_pin);
+r_cdev:
+	cdev_del(&events.cdev);
 r_sysfs:
 	sysfs_remove_group(state.kobj, &attr_group);
+	cancel_work_sync(&calib_job.work);
+	cancel_delayed_work_sync(&work_loop);
 r_kobj:
 	kobject_put(state.kobj);
 r_dev:
-	device_destroy(module_class, 0);
+	device_destroy(module_class, events_devt);
+r_devt:
+	unregister_chrdev_region(events_devt, 1);
 r_class:
 	class_destroy(module_class);
+r_perf:
+	perf_free(&perf);
 
 	return ret;
 }
 
 static void __exit logic_mod_exit(void)
 {
-	cancel_delayed_work_sync(&work_loop);
-	flush_scheduled_work();
-
+	/* Mode requests kick the loop, so silence them first */
 	free_irq(gpio_to_irq(a_button_pin), NULL);
 	gpio_free(a_button_pin);
 
+	/* Attributes request modes and calibration, the kobject stays */
 	sysfs_remove_group(state.kobj, &attr_group);
+
+	/* Replay files kick the loop, remove them before it's stopped */
+	replay_shutdown(&replay);
+	debugfs_remove_recursive(debugfs_dir);
+
+	cancel_work_sync(&calib_job.work);
+	bc_sensor_motion_disarm();
+	loop_stop();
+	pipe_stop(&pipe);
+	flush_scheduled_work();
+
+	/* Processing has stopped, nothing raises events any more */
+	cdev_del(&events.cdev);
 	kobject_put(state.kobj);
 
-	device_destroy(module_class, 0);
+	if (state.mode && state.mode->release)
+		state.mode->release(state.mode);
+
+	layout_free(&screen);
+
+	device_destroy(module_class, events_devt);
+	unregister_chrdev_region(events_devt, 1);
 	class_destroy(module_class);
 
+	perf_free(&perf);
+
 	pr_info(MP "module removed\n");
 }
 
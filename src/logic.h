@@ -4,6 +4,17 @@
 #define __LOGIC_H__
 
 #include <linux/types.h>
+#include <linux/atomic.h>
+#include <linux/spinlock.h>
+#include <linux/workqueue.h>
+#include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/kfifo.h>
+#include <linux/wait.h>
+#include <linux/cdev.h>
+
+#include "fxpt_math.h"
+#include "sensor/sensor_module.h"
 
 #define INIT_DELAY			500
 
@@ -19,6 +30,14 @@
 #define GYRO_Z_SYSFS_ATTR		gyro_z
 #define TEMPERATURE_SYSFS_ATTR		temp
 #define MODE_SYSFS_ATTR			mode
+#define CALIBRATE_SYSFS_ATTR		calibrate
+#define STATS_SYSFS_ATTR		stats
+#define SPECTRUM_SYSFS_ATTR		spectrum
+#define EVENTS_SYSFS_ATTR		events
+#define RULES_SYSFS_ATTR		rules
+#define SAMPLE_SYSFS_ATTR		sample
+#define HEALTH_SYSFS_ATTR		health
+#define CLOCK_SYSFS_ATTR		clock
 
 #define DEFAULT_A_BUTTON_GPIO_PIN	26
 #define A_BUTTON_IRQ_LABEL		LOGIC_DEVICE ": action button"
@@ -26,23 +45,508 @@
 
 #define SM_TXT_OFFSET			16
 
+#define LOGIC_MODE_NONE			(-1)
+
+#define ACCEL_1G			0x4000	/* +-2 g full scale */
+#define GYRO_1DPS			131	/* +-250 dps full scale */
+
+#define CALIB_DEFAULT_SAMPLES		500
+#define CALIB_MAX_SAMPLES		10000
+#define CALIB_PERIOD_US			1000	/* Accel output rate is 1 kHz */
+#define CALIB_ACCEL_VAR_MAX		40000	/* ~12 mg std deviation */
+#define CALIB_GYRO_VAR_MAX		2500	/* ~0.4 dps std deviation */
+
+#define STATS_DEFAULT_WINDOW		400	/* Samples per stats window */
+#define STATS_MAX_WINDOW		100000
+#define STATS_FRAC			8	/* Fraction bits of running mean */
+
+#define SPECTRUM_DEFAULT_RATE		500	/* Hz */
+#define SPECTRUM_BINS			(FXPT_FFT_SIZE / 2)
+#define SPECTRUM_BANDS			8
+#define SPECTRUM_PEAKS			3
+
+#define BATCH_MAX_SAMPLES		80	/* Not less than a full FIFO */
+#define DECODE_DEBUGFS_FILE		"decode"
+#define DECODE_BENCH_ROUNDS		1000	/* Full batches per benchmark */
+
+#define ORIENT_UNIT			1000	/* Mount matrix parameter 1.0 */
+#define ORIENT_FRAC			14	/* Fraction bits of the matrix */
+#define MOUNT_DEFAULT_TOLERANCE		20	/* Off identity, 1/ORIENT_UNIT */
+
+#define DECIM_MAX_RATIO			64	/* Input samples per output */
+#define DECIM_FRAC			4	/* Fraction bits between stages */
+#define DECIM_TAPS			3	/* FIR length */
+
+#define EVENTS_MAX_RULES		8
+#define EVENTS_QUEUE_SIZE		64	/* Records, power of 2 */
+
+#define SAMPLE_RECORD_VERSION		1
+
+#define IDLE_DEFAULT_TIMEOUT		60	/* s, without user interaction */
+#define IDLE_CYCLE_DELAY		1000	/* ms, loop period when idle */
+
+#define PARK_DEFAULT_TIMEOUT		30	/* s, stationary before parking */
+#define MOTION_DEFAULT_THRESHOLD	40	/* mg */
+#define MOTION_DEFAULT_DURATION		5	/* ms */
+
+#define LOOP_DEFAULT_RT_PRIO		50	/* SCHED_FIFO */
+#define LOOP_MAX_BACKOFF		1000	/* ms, loop period on errors */
+
+#define REPLAY_QUEUE_SIZE		1024	/* Records, power of 2 */
+#define CAPTURE_DEBUGFS_FILE		"capture"
+#define REPLAY_DEBUGFS_FILE		"replay"
+
+#define LAYOUT_MAX_FIELDS		8	/* Updatable fields per layout */
+#define LAYOUT_MAX_WIDTH		12	/* Cells per field */
+#define LAYOUT_GLYPH_NONE		0xFF	/* Cell content is unknown */
+#define LAYOUT_MAX_BACKGROUNDS		8	/* Rendered layouts kept */
+
+#define PERF_BUCKETS			20	/* log2 us, last one >= 0.5 s */
+#define PERF_DEBUGFS_FILE		"perf"
+#define LATENCY_WINDOW			256	/* Latest frames per mode */
+#define LATENCY_DEBUGFS_FILE		"latency"
+
+#define PIPE_BATCH_DEPTH		4	/* Batches, power of 2 */
+#define PIPE_FRAME_DEPTH		4	/* Frames, power of 2 */
+#define PIPELINE_DEBUGFS_FILE		"pipeline"
+
+struct logic_frame;
+
+/*
+ * Every callback runs in its pipeline stage: prepare() and release() set
+ * the sensor up in the acquisition one, process() turns the calibrated
+ * batch into a frame in the processing one, show() draws the background
+ * and cycle() the frame in the rendering one.
+ */
 struct logic_mode {
 	int cycle_delay;
-	int (*prepare)(struct logic_mode *mode);
-	int (*cycle)(struct logic_mode *mode);
+	int sample_rate;		/* FIFO sampling rate, 0 - single poll */
+	int decimation;			/* Samples per shown value, 0 - none */
+	int ratio;			/* Decimation in effect, by prepare() */
+	int (*prepare)(struct logic_mode *mode);	/* Optional */
+	int (*process)(struct logic_mode *mode, struct logic_frame *frame);
+	int (*show)(struct logic_mode *mode, const struct logic_frame *frame);
+	int (*cycle)(struct logic_mode *mode, const struct logic_frame *frame);
+	int (*release)(struct logic_mode *mode);	/* Optional */
+};
+
+enum logic_axis {
+	AXIS_ACCEL_X,
+	AXIS_ACCEL_Y,
+	AXIS_ACCEL_Z,
+	AXIS_GYRO_X,
+	AXIS_GYRO_Y,
+	AXIS_GYRO_Z,
+	AXIS_COUNT,
+};
+
+struct calib_offsets {
+	int accel[3];
+	int gyro[3];
+};
+
+struct calib_result {
+	int samples;
+	s32 mean[AXIS_COUNT];
+	u32 var[AXIS_COUNT];
+	struct calib_offsets offsets;
+};
+
+struct axis_stats {
+	u32 count;
+	s32 min;
+	s32 max;
+	s64 mean;			/* Q(STATS_FRAC) */
+	u64 m2;				/* Squared deviations, Q(2 * STATS_FRAC) */
+};
+
+struct logic_stats {
+	spinlock_t lock;		/* Protects everything below */
+	u32 window;
+	u32 windows;			/* Completed windows */
+	ktime_t start;			/* First sample of the window */
+	s64 span;			/* Last completed window, ns */
+	struct axis_stats cur[AXIS_COUNT];	/* Window in progress */
+	struct axis_stats last[AXIS_COUNT];	/* Last completed window */
+	struct axis_stats life[AXIS_COUNT];	/* Since load or reset */
+};
+
+/*
+ * Vibration spectrum of accelerometer axes over FXPT_FFT_SIZE samples.
+ * Powers are |X[k]|^2 in LSB^2 of the Hann-windowed DFT scaled by 1/N.
+ */
+struct spectrum_result {
+	unsigned int rate;		/* Sample rate, Hz */
+	u32 measured;			/* Over the window timestamps, mHz */
+	u32 windows;			/* Analysed windows */
+	u32 peak_bin[3][SPECTRUM_PEAKS];
+	u64 peak_power[3][SPECTRUM_PEAKS];
+	u64 band[3][SPECTRUM_BANDS];
+	u64 power[SPECTRUM_BINS];	/* All axes together */
+};
+
+struct logic_spectrum {
+	s16 win[3][FXPT_FFT_SIZE];	/* Window being collected */
+	int fill;
+	ktime_t start;			/* First sample of the window */
+	spinlock_t lock;		/* Protects res */
+	struct spectrum_result res;
+};
+
+enum orient_angle {
+	ORIENT_PITCH,
+	ORIENT_ROLL,
+	ORIENT_TILT,
+	ORIENT_COUNT,
+};
+
+/* Rotation from sensor to device axes, Q(ORIENT_FRAC) */
+struct orient_mount {
+	s32 m[3][3];
+};
+
+/* Calibrated samples of one acquisition, an array per axis */
+struct logic_batch {
+	int len;
+	ktime_t ts[BATCH_MAX_SAMPLES];			/* Sampling instants */
+	s32 axis[AXIS_COUNT][BATCH_MAX_SAMPLES];
+	s32 angle[ORIENT_COUNT][BATCH_MAX_SAMPLES];	/* Centidegrees */
+};
+
+/*
+ * Decimator: boxcar (first order CIC) averaging of ratio input samples,
+ * then a short FIR at the output rate. Output is in input units.
+ */
+struct logic_decim {
+	int ratio;
+	int fill;			/* Samples in the boxcar */
+	s32 acc[AXIS_COUNT];
+	s32 hist[DECIM_TAPS][AXIS_COUNT];	/* Q(DECIM_FRAC) */
+	int pos;			/* Oldest FIR history entry */
+	bool primed;			/* History holds real outputs */
+	s32 out[AXIS_COUNT];		/* Latest output */
+};
+
+/* Rule sources: accel in mg, gyro in dps, angles in degrees */
+enum event_source {
+	SRC_ACCEL_X,
+	SRC_ACCEL_Y,
+	SRC_ACCEL_Z,
+	SRC_GYRO_X,
+	SRC_GYRO_Y,
+	SRC_GYRO_Z,
+	SRC_ACCEL,			/* Acceleration magnitude */
+	SRC_PITCH,
+	SRC_ROLL,
+	SRC_TILT,			/* Deviation from vertical */
+	SRC_COUNT,
+};
+
+enum event_type {
+	EVENT_ENTER = 1,		/* Rule condition held for its duration */
+	EVENT_LEAVE = 2,		/* Value went back past the hysteresis */
+};
+
+/* Record read from the character device */
+struct logic_event {
+	__u64 timestamp;		/* ns, CLOCK_MONOTONIC */
+	__u32 seq;
+	__u8 rule;
+	__u8 type;
+	__u8 source;
+	__u8 reserved;
+	__s32 value;
+	__u32 duration;			/* ms the condition held (LEAVE) */
+};
+
+/*
+ * Binary sample record (attr/sample), little-endian.
+ * All fields come from a single burst read, raw uncalibrated values.
+ */
+struct logic_sample_record {
+	__le16 version;			/* SAMPLE_RECORD_VERSION */
+	__le16 size;			/* sizeof(struct logic_sample_record) */
+	__le32 seq;
+	__le64 timestamp;		/* ns, CLOCK_MONOTONIC */
+	__le16 accel[3];
+	__le16 gyro[3];
+	__le16 temp;			/* deg C = temp / 340 + 36.53 */
+	__le16 reserved;
+} __packed;
+
+struct event_rule {
+	enum event_source source;
+	bool below;			/* Fires below the threshold */
+	s32 threshold;
+	s32 hysteresis;
+	u32 duration;			/* ms */
+	/* Runtime state */
+	int state;
+	ktime_t since;
+	u32 count;
+};
+
+struct logic_events {
+	struct mutex lock;		/* Protects rules */
+	struct event_rule rules[EVENTS_MAX_RULES];
+	int rule_count;
+	u32 seq;
+	u32 dropped;
+	DECLARE_KFIFO(queue, struct logic_event, EVENTS_QUEUE_SIZE);
+	struct mutex read_lock;		/* Serializes queue consumers */
+	wait_queue_head_t wait;
+	struct kobject *kobj;		/* sysfs_notify() target */
+	struct cdev cdev;
+};
+
+struct perf_hist {
+	u32 bucket[PERF_BUCKETS];
+	u32 count;
+	u32 max;			/* us */
+	u64 sum;			/* us */
+};
+
+enum perf_stage {
+	PERF_ACQUIRE,			/* Work loop run that acquired */
+	PERF_PREPARE,			/* Work loop run that switched modes */
+	PERF_PROCESS,			/* One batch */
+	PERF_RENDER,			/* One frame, transfer included */
+	PERF_STAGES,
+};
+
+struct mode_perf {
+	struct perf_hist late;		/* Start past the scheduled time */
+	struct perf_hist stage[PERF_STAGES];
+	u32 misses;			/* Finished past the next due time */
+	u32 early;			/* Kicked before the scheduled time */
+};
+
+/* Sample to pixels delay of the frames that showed a new sample */
+struct mode_latency {
+	u32 window[LATENCY_WINDOW];	/* us, ring */
+	u32 frames;
+	u32 max;			/* us */
+};
+
+struct logic_perf {
+	spinlock_t lock;
+	int mode_count;
+	struct mode_perf *modes;
+	struct mode_latency *latency;
+	ktime_t expected;		/* KTIME_MAX if not scheduled */
+	unsigned int period;		/* ms */
+	u64 overruns;			/* Loop deadlines skipped */
+};
+
+struct logic_replay {
+	struct mutex open_lock;		/* Serializes opens of both files */
+	bool closing;			/* Module exit, fail blocked users */
+	void (*kick)(void);		/* Runs the work loop right away */
+	/* Capture: acquisition to the capture file reader */
+	bool capturing;
+	u32 capture_dropped;
+	DECLARE_KFIFO(capture, struct logic_sample_record, REPLAY_QUEUE_SIZE);
+	wait_queue_head_t capture_wait;
+	/* Replay: replay file writer to acquisition */
+	bool replaying;
+	bool writer_done;		/* File closed, drain the queue */
+	bool realtime;			/* Paced by recorded timestamps */
+	u32 replayed;
+	s64 ts0;			/* First sample timestamp, ns */
+	ktime_t start;			/* Time the first sample was taken */
+	DECLARE_KFIFO(replay, struct logic_sample_record, REPLAY_QUEUE_SIZE);
+	wait_queue_head_t replay_wait;
+};
+
+/*
+ * Screen element, a static label or a fixed-width updatable field.
+ * Fields are addressed by their index, so they go first in a layout.
+ */
+struct layout_field {
+	u8 offset;			/* px */
+	u8 line;			/* Page */
+	u8 width;			/* Cells, 0 for labels */
+	u8 font;			/* enum display_font_id */
+	const char *label;
+};
+
+#define LAYOUT_LABEL(x, y, f, s)	\
+	{ .offset = (x), .line = (y), .font = (f), .label = (s) }
+#define LAYOUT_FIELD(x, y, f, w)	\
+	{ .offset = (x), .line = (y), .font = (f), .width = (w) }
+#define LAYOUT(f)			\
+	{ .fields = (f), .count = ARRAY_SIZE(f) }
+
+struct logic_layout {
+	const struct layout_field *fields;
+	int count;
+};
+
+/* Samples of one acquisition, handed to the processing stage */
+struct pipe_batch {
+	int mode;
+	int rate;			/* Sample rate of the mode, 0 - polled */
+	bool switched;			/* First batch of the mode */
+	bool historic;			/* Replayed */
+	int len;			/* May be 0 for the first batch */
+	struct sensor_data data[SENSOR_FIFO_MAX_SAMPLES];
+};
+
+/* What the rendering stage draws, values are mode specific */
+struct logic_frame {
+	int mode;
+	int rate;
+	bool switched;			/* Draw the background first */
+	bool historic;			/* No latency accounting */
+	bool update;			/* Values are set */
+	ktime_t timestamp;		/* Read time of the shown sample */
+	union {
+		s32 value[AXIS_COUNT];
+		struct {
+			u64 power[SPECTRUM_BINS];
+			unsigned int peak;	/* 0.1 Hz */
+		};
+	};
+};
+
+struct pipe_queue_stats {
+	u32 queued;
+	u32 dropped;			/* Queue was full */
+	u32 peak;			/* Max depth */
+};
+
+struct pipe_stage {
+	struct work_struct work;
+	int cpu;			/* -1 - any */
+	u32 runs;			/* Items handled */
+};
+
+/*
+ * Acquisition, processing and rendering stages connected by single
+ * producer, single consumer queues.
+ */
+struct logic_pipeline {
+	DECLARE_KFIFO(batches, struct pipe_batch, PIPE_BATCH_DEPTH);
+	DECLARE_KFIFO(frames, struct logic_frame, PIPE_FRAME_DEPTH);
+	struct pipe_queue_stats batch_stats;
+	struct pipe_queue_stats frame_stats;
+	u32 stale;			/* Frames skipped for newer ones */
+	u32 held;			/* Switches that waited for room */
+	bool holding;			/* held_frame waits for room */
+	struct logic_frame held_frame;	/* Processing stage only */
+	struct pipe_stage process;
+	struct pipe_stage render;
+};
+
+/* Labels of a layout rendered into a screen image */
+struct layout_background {
+	const struct logic_layout *layout;
+	u8 *image;
+};
+
+/* Glyphs on the screen, per field cell */
+struct layout_cache {
+	const struct logic_layout *layout;
+	u32 epoch;			/* Display setups the glyphs are for */
+	u8 glyph[LAYOUT_MAX_FIELDS][LAYOUT_MAX_WIDTH];
+	struct layout_background bg[LAYOUT_MAX_BACKGROUNDS];
 };
 
 struct logic_state {
 	const int mode_count;
-	int current_mode;
+	int current_mode;		/* Written by the work loop only */
 	int hidden_modes;
-	bool switching;
+	atomic_t pending_mode;		/* Mode request mailbox */
+	atomic_t requests;		/* Posted mode requests */
+	struct logic_mode *modes;
 	struct logic_mode *mode;
 	struct kobject *kobj;
+	bool idle;			/* Acquire only, nothing is drawn */
+	bool switched;			/* Not yet handed down the pipeline */
+	int (*acquire)(struct logic_state *state);
 };
 
-int switch_mode(struct logic_state *state, struct logic_mode *mode);
+int switch_mode(struct logic_state *state, int mode);
 int next_mode(struct logic_state *state);
 int process_state(struct logic_state *state);
 
+void stats_init(struct logic_stats *st, u32 window);
+void stats_reset(struct logic_stats *st);
+void stats_update(struct logic_stats *st, const s32 *v, ktime_t ts);
+int stats_print(struct logic_stats *st, char *buf, size_t size);
+
+void spectrum_init(struct logic_spectrum *sp);
+void spectrum_reset(struct logic_spectrum *sp, unsigned int rate);
+bool spectrum_feed(struct logic_spectrum *sp, const s32 *accel, ktime_t ts);
+void spectrum_get(struct logic_spectrum *sp, struct spectrum_result *res);
+unsigned int spectrum_freq(const struct spectrum_result *res, int k);
+int spectrum_print(struct logic_spectrum *sp, char *buf, size_t size);
+
+void batch_calibrate(struct logic_batch *b, const struct sensor_data *data,
+		     int count, const struct calib_offsets *c);
+void batch_sample(const struct logic_batch *b, int i, s32 *v);
+void batch_orient(struct logic_batch *b);
+extern const struct file_operations decode_fops;
+
+int orient_check_mount(const int *matrix, int tol);
+void orient_set_mount(const int *matrix);
+void orient_angles(const struct orient_mount *mnt, const s32 *const accel[3],
+		   int count, s32 *const angle[ORIENT_COUNT]);
+void bc_orientation(const s32 *const accel[3], int count,
+		    s32 *const angle[ORIENT_COUNT]);
+
+void decim_reset(struct logic_decim *d, int ratio);
+bool decim_feed(struct logic_decim *d, const struct logic_batch *b);
+
+void events_init(struct logic_events *ev, struct kobject *kobj);
+void events_process(struct logic_events *ev, const s32 *v, const s32 *angle,
+		    ktime_t ts);
+int events_rules_print(struct logic_events *ev, char *buf, size_t size);
+int events_rules_parse(struct logic_events *ev, const char *buf);
+int events_print(struct logic_events *ev, char *buf, size_t size);
+extern const struct file_operations events_fops;
+
+void sample_record_pack(const struct sensor_data *data,
+			struct logic_sample_record *rec);
+void replay_init(struct logic_replay *rp, void (*kick)(void));
+void replay_shutdown(struct logic_replay *rp);
+void replay_capture(struct logic_replay *rp, const struct sensor_data *data,
+		    int count);
+bool replay_active(struct logic_replay *rp);
+bool replay_pending(struct logic_replay *rp);
+int replay_fetch(struct logic_replay *rp, struct sensor_data *data, int max);
+extern const struct file_operations capture_fops;
+extern const struct file_operations replay_fops;
+
+int layout_prepare(struct layout_cache *c, const struct logic_layout *l);
+void layout_free(struct layout_cache *c);
+int layout_text(struct layout_cache *c, int field, const char *text);
+int layout_number(struct layout_cache *c, int field, int value);
+
+void pipe_init(struct logic_pipeline *p, work_func_t process,
+	       work_func_t render);
+void pipe_stop(struct logic_pipeline *p);
+bool pipe_batch_full(struct logic_pipeline *p);
+bool pipe_put_batch(struct logic_pipeline *p, const struct pipe_batch *b);
+bool pipe_get_batch(struct logic_pipeline *p, struct pipe_batch *b);
+bool pipe_put_frame(struct logic_pipeline *p, const struct logic_frame *f);
+void pipe_retry_frame(struct logic_pipeline *p);
+bool pipe_get_frame(struct logic_pipeline *p, struct logic_frame *f);
+extern const struct file_operations pipeline_fops;
+
+int perf_init(struct logic_perf *pf, int mode_count);
+void perf_free(struct logic_perf *pf);
+void perf_expect(struct logic_perf *pf, ktime_t next, int period);
+void perf_overrun(struct logic_perf *pf, u64 periods);
+void perf_account(struct logic_perf *pf, int mode, bool prepared,
+		  ktime_t start, ktime_t end);
+void perf_stage(struct logic_perf *pf, int mode, enum perf_stage stage,
+		ktime_t start, ktime_t end);
+void perf_latency(struct logic_perf *pf, int mode, s64 us);
+extern const struct file_operations perf_fops;
+extern const struct file_operations latency_fops;
+
+int calib_collect(int samples, u32 accel_var_max, u32 gyro_var_max,
+		  struct calib_result *res);
+
 #endif /*__LOGIC_H__ */
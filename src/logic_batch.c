@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/slab.h>
+#include <linux/seq_file.h>
+#include <linux/ktime.h>
+#include <linux/math64.h>
+#include <linux/build_bug.h>
+#include <linux/sched.h>
+#include "sensor/sensor_module.h"
+#include "logic.h"
+
+/*
+ * Everything downstream of acquisition works on calibrated values. They
+ * are computed once per batch into an array per axis: the loop has no
+ * branches and every axis is written contiguously, so the compiler is
+ * free to unroll and vectorize it, and consumers that aggregate (the
+ * decimator) run over whole axes.
+ */
+
+static_assert(BATCH_MAX_SAMPLES >= SENSOR_FIFO_MAX_SAMPLES);
+
+/**
+ * batch_calibrate() - build the calibrated batch
+ * @b: batch to fill
+ * @data: decoded samples, oldest first
+ * @count: number of samples, up to BATCH_MAX_SAMPLES
+ * @c: calibration offsets
+ */
+void batch_calibrate(struct logic_batch *b, const struct sensor_data *data,
+		     int count, const struct calib_offsets *c)
+{
+	int i;
+	s32 ax = c->accel[0], ay = c->accel[1], az = c->accel[2];
+	s32 gx = c->gyro[0], gy = c->gyro[1], gz = c->gyro[2];
+
+	b->len = min(count, BATCH_MAX_SAMPLES);
+
+	for (i = 0; i < b->len; i++) {
+		b->ts[i] = data[i].timestamp;
+		b->axis[AXIS_ACCEL_X][i] = data[i].accel_x + ax;
+		b->axis[AXIS_ACCEL_Y][i] = data[i].accel_y + ay;
+		b->axis[AXIS_ACCEL_Z][i] = data[i].accel_z + az;
+		b->axis[AXIS_GYRO_X][i] = data[i].gyro_x + gx;
+		b->axis[AXIS_GYRO_Y][i] = data[i].gyro_y + gy;
+		b->axis[AXIS_GYRO_Z][i] = data[i].gyro_z + gz;
+	}
+}
+
+/* Values of all axes of sample @i, for per sample consumers */
+void batch_sample(const struct logic_batch *b, int i, s32 *v)
+{
+	int a;
+
+	for (a = 0; a < AXIS_COUNT; a++)
+		v[a] = b->axis[a][i];
+}
+
+/**
+ * batch_orient() - fill in the angles of all samples of the batch
+ * @b: calibrated batch
+ */
+void batch_orient(struct logic_batch *b)
+{
+	const s32 *const accel[3] = {
+		b->axis[AXIS_ACCEL_X],
+		b->axis[AXIS_ACCEL_Y],
+		b->axis[AXIS_ACCEL_Z],
+	};
+	s32 *const angle[ORIENT_COUNT] = {
+		b->angle[ORIENT_PITCH],
+		b->angle[ORIENT_ROLL],
+		b->angle[ORIENT_TILT],
+	};
+
+	bc_orientation(accel, b->len, angle);
+}
+
+#pragma region /* Benchmark */
+
+/*
+ * Full FIFO batches of synthetic frames through the decoder and the
+ * calibration, the cost is per sample and includes nothing but them.
+ */
+
+struct decode_bench {
+	u8 frames[SENSOR_FIFO_MAX_SAMPLES * MPU6050_DATA_SIZE];
+	struct sensor_data data[SENSOR_FIFO_MAX_SAMPLES];
+	struct logic_batch batch;
+};
+
+static void decode_bench_print(struct seq_file *m, const char *name,
+			       u64 ns, u64 samples)
+{
+	u64 rate = ns ? div64_u64(samples * NSEC_PER_SEC, ns) : 0;
+
+	seq_printf(m, "%-10s %llu.%03llu ns/sample %llu samples/s\n", name,
+		   div64_u64(ns, samples), div64_u64(ns * 1000, samples) % 1000,
+		   rate);
+}
+
+static int decode_show(struct seq_file *m, void *v)
+{
+	int i;
+	u64 samples, t_decode = 0, t_calib = 0;
+	ktime_t t0, t1, t2;
+	struct decode_bench *bench;
+	const struct calib_offsets c = {
+		.accel = { 11, -22, 33 },
+		.gyro = { -44, 55, -66 },
+	};
+
+	bench = kmalloc(sizeof(*bench), GFP_KERNEL);
+	if (!bench)
+		return -ENOMEM;
+
+	for (i = 0; i < sizeof(bench->frames); i++)
+		bench->frames[i] = i * 37;
+
+	for (i = 0; i < DECODE_BENCH_ROUNDS; i++) {
+		t0 = ktime_get();
+		bc_sensor_decode(bench->frames, SENSOR_FIFO_MAX_SAMPLES,
+				 bench->data);
+		t1 = ktime_get();
+		batch_calibrate(&bench->batch, bench->data,
+				SENSOR_FIFO_MAX_SAMPLES, &c);
+		t2 = ktime_get();
+
+		t_decode += ktime_to_ns(ktime_sub(t1, t0));
+		t_calib += ktime_to_ns(ktime_sub(t2, t1));
+
+		/* Different input every round, nothing to hoist */
+		bench->frames[i % sizeof(bench->frames)]++;
+		cond_resched();
+	}
+
+	samples = (u64)DECODE_BENCH_ROUNDS * SENSOR_FIFO_MAX_SAMPLES;
+
+	seq_printf(m, "batches %d x %d samples\n", DECODE_BENCH_ROUNDS,
+		   SENSOR_FIFO_MAX_SAMPLES);
+	decode_bench_print(m, "decode", t_decode, samples);
+	decode_bench_print(m, "calibrate", t_calib, samples);
+	decode_bench_print(m, "total", t_decode + t_calib, samples);
+
+	kfree(bench);
+
+	return 0;
+}
+
+static int decode_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, decode_show, inode->i_private);
+}
+
+const struct file_operations decode_fops = {
+	.owner = THIS_MODULE,
+	.open = decode_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+#pragma endregion
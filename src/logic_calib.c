@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/errno.h>
+#include <linux/delay.h>
+#include <linux/math.h>
+#include <linux/math64.h>
+
+#include "sensor/sensor_module.h"
+#include "logic.h"
+
+static void calib_offsets(struct calib_result *res)
+{
+	int i, g = AXIS_ACCEL_X;
+
+	for (i = AXIS_ACCEL_X; i <= AXIS_ACCEL_Z; i++) {
+		res->offsets.accel[i - AXIS_ACCEL_X] = -res->mean[i];
+		if (abs(res->mean[i]) > abs(res->mean[g]))
+			g = i;
+	}
+
+	/* The axis carrying gravity must keep reading exactly 1 g */
+	res->offsets.accel[g - AXIS_ACCEL_X] += res->mean[g] < 0 ?
+						 -ACCEL_1G : ACCEL_1G;
+
+	for (i = AXIS_GYRO_X; i <= AXIS_GYRO_Z; i++)
+		res->offsets.gyro[i - AXIS_GYRO_X] = -res->mean[i];
+}
+
+/**
+ * calib_collect() - collect a calibration burst
+ * @samples: number of samples to collect
+ * @accel_var_max: stillness limit for accelerometer axes variance (LSB^2)
+ * @gyro_var_max: stillness limit for gyroscope axes variance (LSB^2)
+ * @res: per-axis mean, variance and resulting offsets
+ *
+ * Polls the sensor at its output rate and computes per-axis statistics
+ * with exact integer sums. Must be called from a sleepable context.
+ *
+ * Return: 0 on success, -EAGAIN if the device was not still,
+ * error code of the sensor poll otherwise.
+ */
+int calib_collect(int samples, u32 accel_var_max, u32 gyro_var_max,
+		  struct calib_result *res)
+{
+	int i, n, ret;
+	struct sensor_data data;
+	s32 v[AXIS_COUNT];
+	s64 sum[AXIS_COUNT] = { 0 };
+	u64 sumsq[AXIS_COUNT] = { 0 };
+
+	if (samples <= 0 || samples > CALIB_MAX_SAMPLES)
+		return -EINVAL;
+
+	for (n = 0; n < samples; n++) {
+		ret = bc_poll_sensor_raw_data(&data);
+		if (ret < 0)
+			return ret;
+
+		v[AXIS_ACCEL_X] = data.accel_x;
+		v[AXIS_ACCEL_Y] = data.accel_y;
+		v[AXIS_ACCEL_Z] = data.accel_z;
+		v[AXIS_GYRO_X] = data.gyro_x;
+		v[AXIS_GYRO_Y] = data.gyro_y;
+		v[AXIS_GYRO_Z] = data.gyro_z;
+
+		for (i = 0; i < AXIS_COUNT; i++) {
+			sum[i] += v[i];
+			sumsq[i] += (s64)v[i] * v[i];
+		}
+
+		usleep_range(CALIB_PERIOD_US, CALIB_PERIOD_US + 100);
+	}
+
+	res->samples = samples;
+
+	for (i = 0; i < AXIS_COUNT; i++) {
+		u64 sq = (u64)(sum[i] < 0 ? -sum[i] : sum[i]);
+
+		res->mean[i] = div_s64(sum[i] + (sum[i] < 0 ?
+					-samples / 2 : samples / 2), samples);
+		res->var[i] = div_u64(sumsq[i] - div_u64(sq * sq, samples),
+				      samples);
+	}
+
+	calib_offsets(res);
+
+	for (i = 0; i < AXIS_COUNT; i++) {
+		if (res->var[i] > (i < AXIS_GYRO_X ? accel_var_max
+						   : gyro_var_max))
+			return -EAGAIN;
+	}
+
+	return 0;
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/string.h>
+#include "logic.h"
+
+/*
+ * The sensor runs several times faster than a mode shows values. The
+ * boxcar averages every block of ratio samples into one (sinc response,
+ * nulls at multiples of the output rate), the [1 2 1] / 4 FIR then
+ * suppresses what is left around the output Nyquist frequency. Delay is
+ * one and a half output periods, independent of how still the device is.
+ */
+
+static const s32 decim_fir[DECIM_TAPS] = { 1, 2, 1 };
+#define DECIM_FIR_SHIFT	2		/* log2 of the taps sum */
+
+/**
+ * decim_reset() - restart the decimator
+ * @d: decimator
+ * @ratio: input samples per output, 1..DECIM_MAX_RATIO
+ */
+void decim_reset(struct logic_decim *d, int ratio)
+{
+	memset(d, 0, sizeof(*d));
+	d->ratio = ratio;
+}
+
+/* The boxcar is full, averages go through the FIR */
+static void decim_output(struct logic_decim *d)
+{
+	int a, t, i;
+	s32 avg, sum;
+
+	for (a = 0; a < AXIS_COUNT; a++) {
+		avg = DIV_ROUND_CLOSEST(d->acc[a] * (1 << DECIM_FRAC),
+					d->ratio);
+
+		/* No step response from an empty history on start */
+		if (!d->primed)
+			for (t = 0; t < DECIM_TAPS; t++)
+				d->hist[t][a] = avg;
+		d->hist[d->pos][a] = avg;
+
+		sum = 0;
+		for (t = 0, i = d->pos; t < DECIM_TAPS; t++) {
+			sum += decim_fir[t] * d->hist[i][a];
+			i = i ? i - 1 : DECIM_TAPS - 1;
+		}
+
+		d->out[a] = DIV_ROUND_CLOSEST(sum, 1 << (DECIM_FIR_SHIFT +
+							 DECIM_FRAC));
+		d->acc[a] = 0;
+	}
+
+	d->primed = true;
+	d->pos = (d->pos + 1) % DECIM_TAPS;
+	d->fill = 0;
+}
+
+/**
+ * decim_feed() - add a batch of samples
+ * @d: decimator
+ * @b: calibrated samples
+ *
+ * The boxcar sums run over contiguous runs of every axis.
+ *
+ * Return: true if a new output is in d->out.
+ */
+bool decim_feed(struct logic_decim *d, const struct logic_batch *b)
+{
+	int a, i, k, n;
+	s32 sum;
+	bool updated = false;
+
+	for (i = 0; i < b->len; i += n) {
+		n = min(d->ratio - d->fill, b->len - i);
+
+		for (a = 0; a < AXIS_COUNT; a++) {
+			sum = 0;
+			for (k = i; k < i + n; k++)
+				sum += b->axis[a][k];
+			d->acc[a] += sum;
+		}
+
+		d->fill += n;
+		if (d->fill == d->ratio) {
+			decim_output(d);
+			updated = true;
+		}
+	}
+
+	return updated;
+}
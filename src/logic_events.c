@@ -0,0 +1,337 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/poll.h>
+#include <linux/uaccess.h>
+#include <linux/sysfs.h>
+#include <linux/string.h>
+#include <linux/math.h>
+#include "logic.h"
+
+enum rule_state {
+	RULE_IDLE,
+	RULE_PENDING,			/* Condition holds, duration not yet */
+	RULE_ACTIVE,
+};
+
+static const char * const source_names[SRC_COUNT] = {
+	[SRC_ACCEL_X] = "accel_x",
+	[SRC_ACCEL_Y] = "accel_y",
+	[SRC_ACCEL_Z] = "accel_z",
+	[SRC_GYRO_X] = "gyro_x",
+	[SRC_GYRO_Y] = "gyro_y",
+	[SRC_GYRO_Z] = "gyro_z",
+	[SRC_ACCEL] = "accel",
+	[SRC_PITCH] = "pitch",
+	[SRC_ROLL] = "roll",
+	[SRC_TILT] = "tilt",
+};
+
+static const char * const state_names[] = {
+	[RULE_IDLE] = "idle",
+	[RULE_PENDING] = "pending",
+	[RULE_ACTIVE] = "active",
+};
+
+/* Converts a calibrated sample and its angles into rule source units */
+static void events_sources(const s32 *v, const s32 *angle, s32 *src)
+{
+	int i;
+	s64 ax = v[AXIS_ACCEL_X], ay = v[AXIS_ACCEL_Y], az = v[AXIS_ACCEL_Z];
+
+	for (i = AXIS_ACCEL_X; i <= AXIS_ACCEL_Z; i++)
+		src[SRC_ACCEL_X + i] = DIV_ROUND_CLOSEST(v[i] * 1000, ACCEL_1G);
+
+	for (i = AXIS_GYRO_X; i <= AXIS_GYRO_Z; i++)
+		src[SRC_GYRO_X + i - AXIS_GYRO_X] = v[i] / GYRO_1DPS;
+
+	src[SRC_ACCEL] = DIV_ROUND_CLOSEST((s32)int_sqrt64(ax * ax + ay * ay +
+							   az * az) * 1000,
+					   ACCEL_1G);
+	src[SRC_PITCH] = DIV_ROUND_CLOSEST(angle[ORIENT_PITCH], 100);
+	src[SRC_ROLL] = DIV_ROUND_CLOSEST(angle[ORIENT_ROLL], 100);
+	src[SRC_TILT] = DIV_ROUND_CLOSEST(angle[ORIENT_TILT], 100);
+}
+
+static void events_emit(struct logic_events *ev, int idx, enum event_type type,
+			s32 value, ktime_t ts)
+{
+	struct event_rule *rule = &ev->rules[idx];
+	struct logic_event rec = {
+		.timestamp = ktime_to_ns(ts),
+		.seq = ++ev->seq,
+		.rule = idx,
+		.type = type,
+		.source = rule->source,
+		.value = value,
+	};
+
+	if (type == EVENT_LEAVE)
+		rec.duration = ktime_ms_delta(ts, rule->since);
+
+	/* The work loop is the only producer, no locking needed */
+	if (!kfifo_put(&ev->queue, rec))
+		ev->dropped++;
+}
+
+static bool rule_eval(struct logic_events *ev, int idx, s32 value, ktime_t ts)
+{
+	struct event_rule *rule = &ev->rules[idx];
+	bool over, clear;
+
+	/* Both come from sysfs as any int, the bound may not fit in s32 */
+	if (rule->below) {
+		over = value < rule->threshold;
+		clear = value > (s64)rule->threshold + rule->hysteresis;
+	} else {
+		over = value > rule->threshold;
+		clear = value < (s64)rule->threshold - rule->hysteresis;
+	}
+
+	switch (rule->state) {
+	case RULE_IDLE:
+		if (!over)
+			break;
+		rule->state = RULE_PENDING;
+		rule->since = ts;
+		fallthrough;
+	case RULE_PENDING:
+		if (!over) {
+			rule->state = RULE_IDLE;
+			break;
+		}
+		if (ktime_ms_delta(ts, rule->since) < rule->duration)
+			break;
+		rule->state = RULE_ACTIVE;
+		rule->count++;
+		events_emit(ev, idx, EVENT_ENTER, value, ts);
+		return true;
+	case RULE_ACTIVE:
+		if (!clear)
+			break;
+		rule->state = RULE_IDLE;
+		events_emit(ev, idx, EVENT_LEAVE, value, ts);
+		return true;
+	}
+
+	return false;
+}
+
+void events_init(struct logic_events *ev, struct kobject *kobj)
+{
+	mutex_init(&ev->lock);
+	mutex_init(&ev->read_lock);
+	init_waitqueue_head(&ev->wait);
+	INIT_KFIFO(ev->queue);
+	ev->kobj = kobj;
+}
+
+/**
+ * events_process() - evaluate all rules against a sample
+ * @ev: events engine
+ * @v: calibrated sample, one value per axis (see enum logic_axis)
+ * @angle: its pitch, roll and tilt in centidegrees (see enum orient_angle)
+ * @ts: sample timestamp
+ *
+ * Queues a record for every rule state change and notifies pollers
+ * of both the char device and the events sysfs attribute.
+ */
+void events_process(struct logic_events *ev, const s32 *v, const s32 *angle,
+		    ktime_t ts)
+{
+	int i;
+	bool fired = false;
+	s32 src[SRC_COUNT];
+
+	mutex_lock(&ev->lock);
+
+	if (ev->rule_count) {
+		events_sources(v, angle, src);
+
+		for (i = 0; i < ev->rule_count; i++)
+			fired |= rule_eval(ev, i, src[ev->rules[i].source], ts);
+	}
+
+	mutex_unlock(&ev->lock);
+
+	if (fired) {
+		wake_up_interruptible(&ev->wait);
+		sysfs_notify(ev->kobj, NULL, __stringify(EVENTS_SYSFS_ATTR));
+	}
+}
+
+/**
+ * events_rules_parse() - apply a rules command
+ * @ev: events engine
+ * @buf: one of the commands:
+ *	"add <source> <above|below> <threshold> <hysteresis> <duration_ms>"
+ *	"del <index>"
+ *	"clear"
+ *
+ * Return: 0 on success, error code otherwise.
+ */
+int events_rules_parse(struct logic_events *ev, const char *buf)
+{
+	int idx, src, ret = 0;
+	char name[16], op[8];
+	struct event_rule rule = { 0 };
+
+	if (sysfs_streq(buf, "clear")) {
+		mutex_lock(&ev->lock);
+		ev->rule_count = 0;
+		mutex_unlock(&ev->lock);
+		return 0;
+	}
+
+	if (sscanf(buf, "del %d", &idx) == 1) {
+		mutex_lock(&ev->lock);
+		if (idx < 0 || idx >= ev->rule_count) {
+			ret = -EINVAL;
+		} else {
+			memmove(&ev->rules[idx], &ev->rules[idx + 1],
+				(ev->rule_count - idx - 1) * sizeof(rule));
+			ev->rule_count--;
+		}
+		mutex_unlock(&ev->lock);
+		return ret;
+	}
+
+	if (sscanf(buf, "add %15s %7s %d %d %u", name, op, &rule.threshold,
+		   &rule.hysteresis, &rule.duration) != 5)
+		return -EINVAL;
+
+	src = match_string(source_names, ARRAY_SIZE(source_names), name);
+	if (src < 0 || rule.hysteresis < 0)
+		return -EINVAL;
+
+	rule.source = src;
+
+	if (!strcmp(op, "below"))
+		rule.below = true;
+	else if (strcmp(op, "above"))
+		return -EINVAL;
+
+	mutex_lock(&ev->lock);
+	if (ev->rule_count < EVENTS_MAX_RULES)
+		ev->rules[ev->rule_count++] = rule;
+	else
+		ret = -ENOSPC;
+	mutex_unlock(&ev->lock);
+
+	return ret;
+}
+
+int events_rules_print(struct logic_events *ev, char *buf, size_t size)
+{
+	int i, len;
+	struct event_rule *rule;
+
+	len = scnprintf(buf, size, "%-3s %-8s %-5s %9s %5s %8s %-7s %6s\n",
+			"idx", "source", "op", "threshold", "hyst",
+			"duration", "state", "count");
+
+	mutex_lock(&ev->lock);
+
+	for (i = 0; i < ev->rule_count; i++) {
+		rule = &ev->rules[i];
+		len += scnprintf(buf + len, size - len,
+				 "%-3d %-8s %-5s %9d %5d %8u %-7s %6u\n", i,
+				 source_names[rule->source],
+				 rule->below ? "below" : "above",
+				 rule->threshold, rule->hysteresis,
+				 rule->duration, state_names[rule->state],
+				 rule->count);
+	}
+
+	mutex_unlock(&ev->lock);
+
+	return len;
+}
+
+/* Changes every time an event is queued, so it can be poll()ed */
+int events_print(struct logic_events *ev, char *buf, size_t size)
+{
+	int i, len;
+
+	mutex_lock(&ev->lock);
+
+	len = scnprintf(buf, size, "seq: %u\ndropped: %u\nqueued: %u\nactive:",
+			ev->seq, ev->dropped, kfifo_len(&ev->queue));
+
+	for (i = 0; i < ev->rule_count; i++)
+		if (ev->rules[i].state == RULE_ACTIVE)
+			len += scnprintf(buf + len, size - len, " %d", i);
+
+	mutex_unlock(&ev->lock);
+
+	len += scnprintf(buf + len, size - len, "\n");
+
+	return len;
+}
+
+#pragma region /* Character device */
+
+static int events_open(struct inode *inode, struct file *file)
+{
+	file->private_data = container_of(inode->i_cdev, struct logic_events,
+					  cdev);
+
+	return nonseekable_open(inode, file);
+}
+
+static ssize_t events_read(struct file *file, char __user *buf, size_t count,
+			   loff_t *ppos)
+{
+	int ret;
+	unsigned int copied;
+	struct logic_events *ev = file->private_data;
+
+	if (count < sizeof(struct logic_event))
+		return -EINVAL;
+
+	do {
+		if (kfifo_is_empty(&ev->queue)) {
+			if (file->f_flags & O_NONBLOCK)
+				return -EAGAIN;
+
+			ret = wait_event_interruptible(ev->wait,
+					!kfifo_is_empty(&ev->queue));
+			if (ret)
+				return ret;
+		}
+
+		if (mutex_lock_interruptible(&ev->read_lock))
+			return -ERESTARTSYS;
+
+		ret = kfifo_to_user(&ev->queue, buf, count, &copied);
+
+		mutex_unlock(&ev->read_lock);
+
+		if (ret)
+			return ret;
+
+	/* Someone else could drain the queue in between */
+	} while (!copied);
+
+	return copied;
+}
+
+static __poll_t events_poll(struct file *file, poll_table *wait)
+{
+	struct logic_events *ev = file->private_data;
+
+	poll_wait(file, &ev->wait, wait);
+
+	return kfifo_is_empty(&ev->queue) ? 0 : EPOLLIN | EPOLLRDNORM;
+}
+
+const struct file_operations events_fops = {
+	.owner = THIS_MODULE,
+	.open = events_open,
+	.read = events_read,
+	.poll = events_poll,
+	.llseek = no_llseek,
+};
+#pragma endregion
@@ -0,0 +1,178 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/slab.h>
+#include <linux/string.h>
+#include "display/display_module.h"
+#include "logic.h"
+
+/*
+ * Screen layouts: static labels drawn once on prepare and fixed-width
+ * fields updated on every cycle. The glyph last drawn in every field cell
+ * is remembered, only the cells that changed are sent to the display.
+ * The memory is dropped when the display has been set up again, that
+ * clears the screen.
+ *
+ * Labels of a layout are rendered into a screen image on its first use,
+ * switching to the layout sends the pages of the image that differ from
+ * the screen in one transfer.
+ */
+
+/* Rendered labels of the layout, NULL if there is no room or memory */
+static const u8 *layout_background(struct layout_cache *c,
+				   const struct logic_layout *l)
+{
+	int i;
+	struct layout_background *bg;
+	const struct layout_field *f;
+
+	for (i = 0; i < LAYOUT_MAX_BACKGROUNDS; i++) {
+		bg = &c->bg[i];
+		if (bg->layout == l)
+			return bg->image;
+		if (!bg->layout)
+			break;
+	}
+
+	if (i == LAYOUT_MAX_BACKGROUNDS)
+		return NULL;
+
+	bg->image = kzalloc(DISPLAY_IMAGE_SIZE, GFP_KERNEL);
+	if (!bg->image)
+		return NULL;
+
+	for (i = 0; i < l->count; i++) {
+		f = &l->fields[i];
+		if (f->label)
+			bc_display_render(bg->image, f->offset, f->line,
+					  f->font, f->label);
+	}
+
+	bg->layout = l;
+
+	return bg->image;
+}
+
+/**
+ * layout_prepare() - show the labels of a layout on a blank screen
+ * @c: glyph cache of the screen
+ * @l: layout to switch to
+ *
+ * Return: 0 on success, error code otherwise.
+ */
+int layout_prepare(struct layout_cache *c, const struct logic_layout *l)
+{
+	int i, ret;
+	const u8 *image;
+	const struct layout_field *f;
+
+	c->layout = l;
+	c->epoch = bc_display_epoch();
+	memset(c->glyph, LAYOUT_GLYPH_NONE, sizeof(c->glyph));
+
+	image = layout_background(c, l);
+	if (image)
+		return bc_display_image(image);
+
+	ret = bc_display_clear();
+	if (ret < 0)
+		return ret;
+
+	for (i = 0; i < l->count; i++) {
+		f = &l->fields[i];
+		if (f->label)
+			bc_display_print(f->offset, f->line, f->font,
+					 (char *)f->label);
+	}
+
+	return 0;
+}
+
+/* Drops the rendered layouts */
+void layout_free(struct layout_cache *c)
+{
+	int i;
+
+	for (i = 0; i < LAYOUT_MAX_BACKGROUNDS; i++)
+		kfree(c->bg[i].image);
+
+	memset(c->bg, 0, sizeof(c->bg));
+	c->layout = NULL;
+}
+
+/**
+ * layout_text() - update a field
+ * @c: glyph cache of the screen
+ * @field: field index in the current layout
+ * @text: left-aligned text, padded with spaces to the field width
+ *
+ * Return: 0 on success, error code if some cell could not be drawn.
+ */
+int layout_text(struct layout_cache *c, int field, const char *text)
+{
+	int i, ret, err = 0;
+	char ch;
+	u8 glyph;
+	const struct layout_field *f;
+	const struct display_font_info *font;
+
+	if (!c->layout || field < 0 || field >= c->layout->count ||
+	    field >= LAYOUT_MAX_FIELDS)
+		return -EINVAL;
+
+	f = &c->layout->fields[field];
+	font = bc_display_font(f->font);
+	if (!font || !f->width || f->width > LAYOUT_MAX_WIDTH)
+		return -EINVAL;
+
+	if (c->epoch != bc_display_epoch()) {
+		c->epoch = bc_display_epoch();
+		memset(c->glyph, LAYOUT_GLYPH_NONE, sizeof(c->glyph));
+	}
+
+	for (i = 0; i < f->width; i++) {
+		ch = *text ? *text++ : ' ';
+		glyph = display_font_symbol(font, ch);
+		if (c->glyph[field][i] == glyph)
+			continue;
+
+		/* Failed or shed cells are drawn again on the next update */
+		ret = bc_display_print(f->offset + i * font->space, f->line,
+				       f->font, (char[]){ch, '\0'});
+		if (ret < 0) {
+			c->glyph[field][i] = LAYOUT_GLYPH_NONE;
+			err = ret;
+		} else {
+			c->glyph[field][i] = glyph;
+		}
+	}
+
+	return err;
+}
+
+/**
+ * layout_number() - update a numeric field
+ * @c: glyph cache of the screen
+ * @field: field index in the current layout
+ * @value: right-aligned in the field, all '*' if it doesn't fit
+ *
+ * Return: 0 on success, error code if some cell could not be drawn.
+ */
+int layout_number(struct layout_cache *c, int field, int value)
+{
+	int len, width;
+	char s[LAYOUT_MAX_WIDTH + 1];
+
+	if (!c->layout || field < 0 || field >= c->layout->count)
+		return -EINVAL;
+
+	width = min_t(int, c->layout->fields[field].width, LAYOUT_MAX_WIDTH);
+
+	len = snprintf(s, sizeof(s), "%*d", width, value);
+	if (len > width) {
+		memset(s, '*', width);
+		s[width] = '\0';
+	}
+
+	return layout_text(c, field, s);
+}
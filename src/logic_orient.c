@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/spinlock.h>
+#include <linux/math.h>
+#include "logic.h"
+
+/*
+ * Angles come from the gravity vector in the device frame. The mount
+ * matrix rotates sensor axes into it (device = M * sensor, the same
+ * convention as the IIO mount-matrix), it is converted to Q(ORIENT_FRAC)
+ * once when it changes. A batch takes a single copy of it and runs one
+ * loop over all samples.
+ *
+ *   pitch - device x against the yz plane, -90..90
+ *   roll  - device y against z, -180..180
+ *   tilt  - device z against vertical, 0..180
+ */
+
+#define ORIENT_ONE	(1 << ORIENT_FRAC)
+
+static DEFINE_SPINLOCK(mount_lock);
+static struct orient_mount mount = {
+	.m = {
+		{ ORIENT_ONE, 0, 0 },
+		{ 0, ORIENT_ONE, 0 },
+		{ 0, 0, ORIENT_ONE },
+	},
+};
+
+/* Centidegrees, fxpt_atan2() takes up to 16 bit magnitudes */
+static inline s32 orient_atan2(s32 y, s32 x)
+{
+	while (abs(y) > S16_MAX || abs(x) > S16_MAX) {
+		y /= 2;
+		x /= 2;
+	}
+
+	return DIV_ROUND_CLOSEST(fxpt_atan2(y, x) * 18000, FXPT_PI);
+}
+
+/**
+ * orient_check_mount() - validate a mounting
+ * @matrix: row-major 3x3, ORIENT_UNIT stands for 1
+ * @tol: allowed deviation of M * M^T from identity, 1/ORIENT_UNIT parts,
+ *	 negative skips the check
+ *
+ * Any rotation is taken as long as every entry is within +-ORIENT_UNIT,
+ * that keeps the Q(ORIENT_FRAC) conversion in an int and the s64 rotation
+ * of a 16 bit sample far from overflow. With @tol not negative the rows
+ * must also be of unit length and perpendicular to each other within @tol,
+ * so a rounded rotation passes and a mistyped one doesn't.
+ *
+ * Return: 0 if the matrix is usable, -EINVAL otherwise.
+ */
+int orient_check_mount(const int *matrix, int tol)
+{
+	int i, j, k;
+	s64 dot;
+
+	for (i = 0; i < 9; i++)
+		if (abs(matrix[i]) > ORIENT_UNIT)
+			return -EINVAL;
+
+	if (tol < 0)
+		return 0;
+
+	for (i = 0; i < 3; i++) {
+		for (j = i; j < 3; j++) {
+			dot = 0;
+			for (k = 0; k < 3; k++)
+				dot += (s64)matrix[i * 3 + k] * matrix[j * 3 + k];
+
+			if (i == j)
+				dot -= (s64)ORIENT_UNIT * ORIENT_UNIT;
+
+			if (abs(dot) > (s64)tol * ORIENT_UNIT)
+				return -EINVAL;
+		}
+	}
+
+	return 0;
+}
+
+/**
+ * orient_set_mount() - set the sensor mounting
+ * @matrix: row-major 3x3 rotation from sensor to device axes,
+ *	    ORIENT_UNIT stands for 1, see orient_check_mount()
+ */
+void orient_set_mount(const int *matrix)
+{
+	int i;
+	struct orient_mount m;
+
+	for (i = 0; i < 9; i++)
+		m.m[i / 3][i % 3] = DIV_ROUND_CLOSEST(matrix[i] * ORIENT_ONE,
+						      ORIENT_UNIT);
+
+	spin_lock(&mount_lock);
+	mount = m;
+	spin_unlock(&mount_lock);
+}
+
+/**
+ * orient_angles() - pitch, roll and tilt of a batch
+ * @mnt: mount rotation
+ * @accel: x, y and z arrays of calibrated acceleration, any common scale
+ * @count: number of samples
+ * @angle: arrays to fill, indexed by enum orient_angle, centidegrees
+ */
+void orient_angles(const struct orient_mount *mnt, const s32 *const accel[3],
+		   int count, s32 *const angle[ORIENT_COUNT])
+{
+	int i;
+	s64 sx, sy, sz, x, y, z;
+	const s32 (*m)[3] = mnt->m;
+
+	for (i = 0; i < count; i++) {
+		sx = accel[0][i];
+		sy = accel[1][i];
+		sz = accel[2][i];
+
+		x = (m[0][0] * sx + m[0][1] * sy + m[0][2] * sz) >> ORIENT_FRAC;
+		y = (m[1][0] * sx + m[1][1] * sy + m[1][2] * sz) >> ORIENT_FRAC;
+		z = (m[2][0] * sx + m[2][1] * sy + m[2][2] * sz) >> ORIENT_FRAC;
+
+		angle[ORIENT_PITCH][i] =
+			orient_atan2(x, int_sqrt64(y * y + z * z));
+		angle[ORIENT_ROLL][i] = orient_atan2(y, z);
+		angle[ORIENT_TILT][i] =
+			orient_atan2(int_sqrt64(x * x + y * y), z);
+	}
+}
+
+/**
+ * bc_orientation() - pitch, roll and tilt of a batch
+ * @accel: x, y and z arrays of calibrated acceleration, any common scale
+ * @count: number of samples
+ * @angle: arrays to fill, indexed by enum orient_angle, centidegrees
+ *
+ * Uses the mounting set by the mount_matrix parameter of the module.
+ */
+void bc_orientation(const s32 *const accel[3], int count,
+		    s32 *const angle[ORIENT_COUNT])
+{
+	struct orient_mount m;
+
+	spin_lock(&mount_lock);
+	m = mount;
+	spin_unlock(&mount_lock);
+
+	orient_angles(&m, accel, count, angle);
+}
+EXPORT_SYMBOL(bc_orientation);
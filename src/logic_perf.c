@@ -0,0 +1,325 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/slab.h>
+#include <linux/seq_file.h>
+#include <linux/log2.h>
+#include <linux/math64.h>
+#include <linux/sort.h>
+#include "logic.h"
+
+/*
+ * Work loop timing. The loop tells when it expects to run next, every
+ * run is accounted against that: lateness of the start, duration of the
+ * acquisition (or mode switch) and whether it finished past the next due
+ * time. The processing and rendering stages are timed per batch and per
+ * frame, each runs on its own, so the slowest one limits the throughput.
+ * Histograms have power of 2 microsecond buckets.
+ *
+ * Motion-to-photon latency is the time from the burst read of the sample
+ * a frame shows to the end of the frame transfer. Percentiles are taken
+ * over the latest LATENCY_WINDOW frames of every mode.
+ */
+
+static void hist_add(struct perf_hist *h, s64 us)
+{
+	u32 v = clamp_t(s64, us, 0, U32_MAX);
+
+	h->bucket[min_t(int, v > 1 ? ilog2(v) : 0, PERF_BUCKETS - 1)]++;
+	h->count++;
+	h->sum += v;
+	h->max = max(h->max, v);
+}
+
+int perf_init(struct logic_perf *pf, int mode_count)
+{
+	pf->modes = kcalloc(mode_count, sizeof(*pf->modes), GFP_KERNEL);
+	if (!pf->modes)
+		return -ENOMEM;
+
+	pf->latency = kcalloc(mode_count, sizeof(*pf->latency), GFP_KERNEL);
+	if (!pf->latency) {
+		kfree(pf->modes);
+		pf->modes = NULL;
+		return -ENOMEM;
+	}
+
+	spin_lock_init(&pf->lock);
+	pf->mode_count = mode_count;
+	pf->expected = KTIME_MAX;
+
+	return 0;
+}
+
+void perf_free(struct logic_perf *pf)
+{
+	kfree(pf->modes);
+	pf->modes = NULL;
+	kfree(pf->latency);
+	pf->latency = NULL;
+}
+
+/**
+ * perf_expect() - set the time the loop is scheduled to run next
+ * @pf: perf accounting
+ * @next: scheduled time, KTIME_MAX if the loop isn't scheduled
+ * @period: ms between the runs
+ */
+void perf_expect(struct logic_perf *pf, ktime_t next, int period)
+{
+	spin_lock(&pf->lock);
+
+	pf->expected = next;
+	if (next != KTIME_MAX)
+		pf->period = period;
+
+	spin_unlock(&pf->lock);
+}
+
+/**
+ * perf_overrun() - account loop deadlines skipped
+ * @pf: perf accounting
+ * @periods: number of deadlines that had passed before they were set
+ */
+void perf_overrun(struct logic_perf *pf, u64 periods)
+{
+	spin_lock(&pf->lock);
+	pf->overruns += periods;
+	spin_unlock(&pf->lock);
+}
+
+/**
+ * perf_account() - account one run of the loop
+ * @pf: perf accounting
+ * @mode: mode that has run
+ * @prepared: prepare() has run instead of cycle()
+ * @start: loop start time
+ * @end: loop end time
+ */
+void perf_account(struct logic_perf *pf, int mode, bool prepared,
+		  ktime_t start, ktime_t end)
+{
+	struct mode_perf *mp;
+	s64 late;
+
+	if (mode < 0 || mode >= pf->mode_count)
+		return;
+
+	spin_lock(&pf->lock);
+
+	mp = &pf->modes[mode];
+
+	if (pf->expected == KTIME_MAX || ktime_before(start, pf->expected)) {
+		/* Mode requests and wakeups kick the loop ahead of time */
+		mp->early++;
+	} else {
+		late = ktime_us_delta(start, pf->expected);
+		hist_add(&mp->late, late);
+		if (late + ktime_us_delta(end, start) >
+		    pf->period * USEC_PER_MSEC)
+			mp->misses++;
+	}
+
+	hist_add(&mp->stage[prepared ? PERF_PREPARE : PERF_ACQUIRE],
+		 ktime_us_delta(end, start));
+
+	spin_unlock(&pf->lock);
+}
+
+/**
+ * perf_stage() - account one run of a pipeline stage
+ * @pf: perf accounting
+ * @mode: mode the batch or frame belongs to
+ * @stage: PERF_PROCESS or PERF_RENDER
+ * @start: stage start time
+ * @end: stage end time
+ */
+void perf_stage(struct logic_perf *pf, int mode, enum perf_stage stage,
+		ktime_t start, ktime_t end)
+{
+	if (mode < 0 || mode >= pf->mode_count || stage >= PERF_STAGES)
+		return;
+
+	spin_lock(&pf->lock);
+	hist_add(&pf->modes[mode].stage[stage], ktime_us_delta(end, start));
+	spin_unlock(&pf->lock);
+}
+
+/**
+ * perf_latency() - account motion-to-photon latency of a frame
+ * @pf: perf accounting
+ * @mode: mode that has drawn the frame
+ * @us: time from the sample read to the end of the frame transfer
+ */
+void perf_latency(struct logic_perf *pf, int mode, s64 us)
+{
+	struct mode_latency *ml;
+	u32 v = clamp_t(s64, us, 0, U32_MAX);
+
+	if (mode < 0 || mode >= pf->mode_count)
+		return;
+
+	spin_lock(&pf->lock);
+
+	ml = &pf->latency[mode];
+	ml->window[ml->frames % LATENCY_WINDOW] = v;
+	ml->frames++;
+	ml->max = max(ml->max, v);
+
+	spin_unlock(&pf->lock);
+}
+
+static void perf_hist_print(struct seq_file *m, const char *name,
+			    const struct perf_hist *h)
+{
+	int i;
+
+	seq_printf(m, "  %-8s count %u avg %llu max %u\n", name, h->count,
+		   h->count ? div_u64(h->sum, h->count) : 0, h->max);
+
+	for (i = 0; i < PERF_BUCKETS - 1; i++)
+		if (h->bucket[i])
+			seq_printf(m, "    < %8lu us: %u\n",
+				   1UL << (i + 1), h->bucket[i]);
+
+	/* The last bucket takes everything longer */
+	if (h->bucket[i])
+		seq_printf(m, "   >= %8lu us: %u\n", 1UL << i, h->bucket[i]);
+}
+
+static const char * const stage_names[PERF_STAGES] = {
+	[PERF_ACQUIRE] = "acquire",
+	[PERF_PREPARE] = "prepare",
+	[PERF_PROCESS] = "process",
+	[PERF_RENDER] = "render",
+};
+
+static int perf_show(struct seq_file *m, void *v)
+{
+	int i, s;
+	u64 overruns;
+	struct mode_perf *snap;
+	struct logic_perf *pf = m->private;
+
+	snap = kmalloc_array(pf->mode_count, sizeof(*snap), GFP_KERNEL);
+	if (!snap)
+		return -ENOMEM;
+
+	spin_lock(&pf->lock);
+	memcpy(snap, pf->modes, pf->mode_count * sizeof(*snap));
+	overruns = pf->overruns;
+	spin_unlock(&pf->lock);
+
+	seq_printf(m, "loop overruns %llu\n", overruns);
+
+	for (i = 0; i < pf->mode_count; i++) {
+		if (!snap[i].stage[PERF_ACQUIRE].count &&
+		    !snap[i].stage[PERF_PREPARE].count)
+			continue;
+
+		seq_printf(m, "mode %d: misses %u early %u\n", i,
+			   snap[i].misses, snap[i].early);
+		perf_hist_print(m, "late", &snap[i].late);
+		for (s = 0; s < PERF_STAGES; s++)
+			perf_hist_print(m, stage_names[s], &snap[i].stage[s]);
+	}
+
+	kfree(snap);
+
+	return 0;
+}
+
+static int perf_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, perf_show, inode->i_private);
+}
+
+/* Any write resets the counters */
+static ssize_t perf_write(struct file *file, const char __user *buf,
+			  size_t count, loff_t *ppos)
+{
+	struct logic_perf *pf = file_inode(file)->i_private;
+
+	spin_lock(&pf->lock);
+	memset(pf->modes, 0, pf->mode_count * sizeof(*pf->modes));
+	pf->overruns = 0;
+	spin_unlock(&pf->lock);
+
+	return count;
+}
+
+static int u32_cmp(const void *a, const void *b)
+{
+	u32 x = *(const u32 *)a, y = *(const u32 *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+static int latency_show(struct seq_file *m, void *v)
+{
+	int i, n;
+	struct mode_latency *snap;
+	struct logic_perf *pf = m->private;
+
+	snap = kmalloc(sizeof(*snap), GFP_KERNEL);
+	if (!snap)
+		return -ENOMEM;
+
+	for (i = 0; i < pf->mode_count; i++) {
+		spin_lock(&pf->lock);
+		*snap = pf->latency[i];
+		spin_unlock(&pf->lock);
+
+		if (!snap->frames)
+			continue;
+
+		n = min_t(u32, snap->frames, LATENCY_WINDOW);
+		sort(snap->window, n, sizeof(u32), u32_cmp, NULL);
+
+		seq_printf(m, "mode %d: frames %u p50 %u p99 %u max %u us\n",
+			   i, snap->frames, snap->window[(n - 1) * 50 / 100],
+			   snap->window[(n - 1) * 99 / 100], snap->max);
+	}
+
+	kfree(snap);
+
+	return 0;
+}
+
+static int latency_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, latency_show, inode->i_private);
+}
+
+/* Any write resets the counters */
+static ssize_t latency_write(struct file *file, const char __user *buf,
+			     size_t count, loff_t *ppos)
+{
+	struct logic_perf *pf = file_inode(file)->i_private;
+
+	spin_lock(&pf->lock);
+	memset(pf->latency, 0, pf->mode_count * sizeof(*pf->latency));
+	spin_unlock(&pf->lock);
+
+	return count;
+}
+
+const struct file_operations latency_fops = {
+	.owner = THIS_MODULE,
+	.open = latency_open,
+	.read = seq_read,
+	.write = latency_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
+
+const struct file_operations perf_fops = {
+	.owner = THIS_MODULE,
+	.open = perf_open,
+	.read = seq_read,
+	.write = perf_write,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
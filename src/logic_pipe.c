@@ -0,0 +1,206 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/seq_file.h>
+#include <linux/kfifo.h>
+#include <linux/cpumask.h>
+#include <linux/workqueue.h>
+#include "logic.h"
+
+/*
+ * The work loop acquires samples and hands them to the processing stage,
+ * which hands frames to the rendering stage. Both are work items, each
+ * queue has exactly one producer and one consumer, so no locks are taken.
+ * A full queue drops the new item, the rendering stage skips frames that
+ * have newer ones queued behind them. A frame that switches the mode is
+ * never lost: it is held until the renderer makes room, newer frames are
+ * merged into it meanwhile. Throughput is limited by the slowest stage
+ * rather than by the sum of all three.
+ */
+
+static void pipe_kick(struct pipe_stage *st)
+{
+	int cpu = READ_ONCE(st->cpu);
+
+	if (cpu < 0 || cpu >= nr_cpu_ids || !cpu_online(cpu))
+		cpu = WORK_CPU_UNBOUND;
+
+	queue_work_on(cpu, system_highpri_wq, &st->work);
+}
+
+static void pipe_account(struct pipe_queue_stats *qs, bool queued,
+			 unsigned int depth)
+{
+	if (!queued) {
+		qs->dropped++;
+		return;
+	}
+
+	qs->queued++;
+	qs->peak = max(qs->peak, depth);
+}
+
+void pipe_init(struct logic_pipeline *p, work_func_t process,
+	       work_func_t render)
+{
+	INIT_KFIFO(p->batches);
+	INIT_KFIFO(p->frames);
+	INIT_WORK(&p->process.work, process);
+	INIT_WORK(&p->render.work, render);
+}
+
+/* Called once the acquisition has stopped, drains the stages in order */
+void pipe_stop(struct logic_pipeline *p)
+{
+	flush_work(&p->process.work);
+	WRITE_ONCE(p->holding, false);
+	flush_work(&p->render.work);
+	flush_work(&p->process.work);
+}
+
+/* Acquisition side, lets replay wait instead of losing samples */
+bool pipe_batch_full(struct logic_pipeline *p)
+{
+	return kfifo_is_full(&p->batches);
+}
+
+/**
+ * pipe_put_batch() - pass a batch to the processing stage
+ * @p: pipeline
+ * @b: batch, copied
+ *
+ * Return: false if the queue is full and the batch is dropped.
+ */
+bool pipe_put_batch(struct logic_pipeline *p, const struct pipe_batch *b)
+{
+	bool queued = kfifo_in(&p->batches, b, 1);
+
+	pipe_account(&p->batch_stats, queued, kfifo_len(&p->batches));
+	pipe_kick(&p->process);
+
+	return queued;
+}
+
+bool pipe_get_batch(struct logic_pipeline *p, struct pipe_batch *b)
+{
+	if (!kfifo_out(&p->batches, b, 1))
+		return false;
+
+	p->process.runs++;
+
+	return true;
+}
+
+static bool pipe_push_frame(struct logic_pipeline *p,
+			    const struct logic_frame *f)
+{
+	bool queued = kfifo_in(&p->frames, f, 1);
+
+	if (queued || !f->switched) {
+		pipe_account(&p->frame_stats, queued, kfifo_len(&p->frames));
+	} else if (!p->holding) {
+		p->held_frame = *f;
+		p->held++;
+	}
+
+	WRITE_ONCE(p->holding, !queued && f->switched);
+	pipe_kick(&p->render);
+
+	return queued;
+}
+
+/**
+ * pipe_put_frame() - pass a frame to the rendering stage
+ * @p: pipeline
+ * @f: frame, copied
+ *
+ * Return: false if the queue is full and the frame is dropped or held.
+ */
+bool pipe_put_frame(struct logic_pipeline *p, const struct logic_frame *f)
+{
+	/* The renderer draws the background of a held switch first anyway */
+	if (p->holding) {
+		p->held_frame = *f;
+		p->held_frame.switched = true;
+		f = &p->held_frame;
+	}
+
+	return pipe_push_frame(p, f);
+}
+
+/* Processing side, queues the held switch once the renderer made room */
+void pipe_retry_frame(struct logic_pipeline *p)
+{
+	if (p->holding)
+		pipe_push_frame(p, &p->held_frame);
+}
+
+/**
+ * pipe_get_frame() - take the next frame to draw
+ * @p: pipeline
+ * @f: frame to fill
+ *
+ * Frames with newer ones queued behind them are skipped, unless they
+ * switch the mode.
+ *
+ * Return: false if there is nothing to draw.
+ */
+bool pipe_get_frame(struct logic_pipeline *p, struct logic_frame *f)
+{
+	while (kfifo_out(&p->frames, f, 1)) {
+		if (f->switched || kfifo_is_empty(&p->frames)) {
+			p->render.runs++;
+			return true;
+		}
+
+		p->stale++;
+	}
+
+	/* There is room now, the processing stage queues the held switch */
+	if (READ_ONCE(p->holding))
+		pipe_kick(&p->process);
+
+	return false;
+}
+
+static void pipe_queue_print(struct seq_file *m, const char *name,
+			     unsigned int depth, unsigned int size,
+			     const struct pipe_queue_stats *qs)
+{
+	seq_printf(m, "%-8s depth %u/%u peak %u queued %u dropped %u\n",
+		   name, depth, size, READ_ONCE(qs->peak),
+		   READ_ONCE(qs->queued), READ_ONCE(qs->dropped));
+}
+
+static int pipeline_show(struct seq_file *m, void *v)
+{
+	struct logic_pipeline *p = m->private;
+
+	pipe_queue_print(m, "batches", kfifo_len(&p->batches),
+			 kfifo_size(&p->batches), &p->batch_stats);
+	pipe_queue_print(m, "frames", kfifo_len(&p->frames),
+			 kfifo_size(&p->frames), &p->frame_stats);
+
+	seq_printf(m, "process  cpu %d runs %u\n", READ_ONCE(p->process.cpu),
+		   READ_ONCE(p->process.runs));
+	seq_printf(m, "render   cpu %d runs %u stale %u held %u\n",
+		   READ_ONCE(p->render.cpu), READ_ONCE(p->render.runs),
+		   READ_ONCE(p->stale), READ_ONCE(p->held));
+
+	return 0;
+}
+
+static int pipeline_open(struct inode *inode, struct file *file)
+{
+	return single_open(file, pipeline_show, inode->i_private);
+}
+
+const struct file_operations pipeline_fops = {
+	.owner = THIS_MODULE,
+	.open = pipeline_open,
+	.read = seq_read,
+	.llseek = seq_lseek,
+	.release = single_release,
+};
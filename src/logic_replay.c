@@ -0,0 +1,359 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/fs.h>
+#include <linux/poll.h>
+#include <linux/uaccess.h>
+#include "sensor/sensor_module.h"
+#include "logic.h"
+
+#define MP KBUILD_MODNAME ": "		/* Log Message Prefix */
+
+/*
+ * Capture and replay of the acquired sample stream. Both use the binary
+ * sample record, so a capture can be fed back as is:
+ *   cat capture > run.bin; ...; cat run.bin > replay
+ * While a replay is active acquisition takes samples from the replay queue
+ * instead of the sensor, either paced by the recorded timestamps or as
+ * fast as the loop can process them.
+ */
+
+/**
+ * sample_record_pack() - convert a sample to the binary record
+ * @data: raw sample
+ * @rec: record to fill
+ */
+void sample_record_pack(const struct sensor_data *data,
+			struct logic_sample_record *rec)
+{
+	rec->version = cpu_to_le16(SAMPLE_RECORD_VERSION);
+	rec->size = cpu_to_le16(sizeof(*rec));
+	rec->seq = cpu_to_le32(data->seq);
+	rec->timestamp = cpu_to_le64(ktime_to_ns(data->timestamp));
+	rec->accel[0] = cpu_to_le16(data->accel_x);
+	rec->accel[1] = cpu_to_le16(data->accel_y);
+	rec->accel[2] = cpu_to_le16(data->accel_z);
+	rec->gyro[0] = cpu_to_le16(data->gyro_x);
+	rec->gyro[1] = cpu_to_le16(data->gyro_y);
+	rec->gyro[2] = cpu_to_le16(data->gyro_z);
+	rec->temp = cpu_to_le16(data->temp);
+	rec->reserved = 0;
+}
+
+static void sample_record_unpack(const struct logic_sample_record *rec,
+				 struct sensor_data *data)
+{
+	data->seq = le32_to_cpu(rec->seq);
+	data->timestamp = ns_to_ktime(le64_to_cpu(rec->timestamp));
+	data->accel_x = le16_to_cpu(rec->accel[0]);
+	data->accel_y = le16_to_cpu(rec->accel[1]);
+	data->accel_z = le16_to_cpu(rec->accel[2]);
+	data->gyro_x = le16_to_cpu(rec->gyro[0]);
+	data->gyro_y = le16_to_cpu(rec->gyro[1]);
+	data->gyro_z = le16_to_cpu(rec->gyro[2]);
+	data->temp = le16_to_cpu(rec->temp);
+}
+
+/**
+ * replay_init() - initialize capture and replay
+ * @rp: capture and replay state
+ * @kick: runs the work loop as soon as possible
+ */
+void replay_init(struct logic_replay *rp, void (*kick)(void))
+{
+	mutex_init(&rp->open_lock);
+	INIT_KFIFO(rp->capture);
+	INIT_KFIFO(rp->replay);
+	init_waitqueue_head(&rp->capture_wait);
+	init_waitqueue_head(&rp->replay_wait);
+	rp->kick = kick;
+}
+
+/**
+ * replay_shutdown() - wake up and fail all blocked readers and writers
+ * @rp: capture and replay state
+ */
+void replay_shutdown(struct logic_replay *rp)
+{
+	WRITE_ONCE(rp->closing, true);
+	wake_up_interruptible(&rp->capture_wait);
+	wake_up_interruptible(&rp->replay_wait);
+}
+
+/**
+ * replay_capture() - queue acquired samples for the capture reader
+ * @rp: capture and replay state
+ * @data: samples, oldest first
+ * @count: number of samples
+ *
+ * Samples that don't fit are dropped and counted, acquisition never waits.
+ */
+void replay_capture(struct logic_replay *rp, const struct sensor_data *data,
+		    int count)
+{
+	int i;
+	struct logic_sample_record rec;
+
+	if (!READ_ONCE(rp->capturing))
+		return;
+
+	for (i = 0; i < count; i++) {
+		sample_record_pack(&data[i], &rec);
+		if (!kfifo_put(&rp->capture, rec))
+			rp->capture_dropped++;
+	}
+
+	wake_up_interruptible(&rp->capture_wait);
+}
+
+/**
+ * replay_active() - check whether acquisition is fed from the replay queue
+ * @rp: capture and replay state
+ *
+ * Return: true from opening the replay file till its queue is drained
+ * after close.
+ */
+bool replay_active(struct logic_replay *rp)
+{
+	return smp_load_acquire(&rp->replaying);
+}
+
+/**
+ * replay_pending() - check whether the loop should run again right away
+ * @rp: capture and replay state
+ *
+ * Return: true if an unpaced replay has queued samples.
+ */
+bool replay_pending(struct logic_replay *rp)
+{
+	return READ_ONCE(rp->replaying) && !READ_ONCE(rp->realtime) &&
+	       !kfifo_is_empty(&rp->replay);
+}
+
+/**
+ * replay_fetch() - take replayed samples that are due
+ * @rp: capture and replay state
+ * @data: buffer for samples, oldest first
+ * @max: buffer size
+ *
+ * Called by the work loop only. Paced replay keeps the recorded intervals
+ * relative to the first sample.
+ *
+ * Return: number of samples, 0 if none is due yet.
+ */
+int replay_fetch(struct logic_replay *rp, struct sensor_data *data, int max)
+{
+	int n = 0;
+	s64 ts;
+	ktime_t now = ktime_get();
+	struct logic_sample_record rec;
+
+	while (n < max && kfifo_peek(&rp->replay, &rec)) {
+		ts = le64_to_cpu(rec.timestamp);
+
+		if (!rp->replayed) {
+			rp->ts0 = ts;
+			rp->start = now;
+		}
+
+		if (READ_ONCE(rp->realtime) &&
+		    ts - rp->ts0 > ktime_to_ns(ktime_sub(now, rp->start)))
+			break;
+
+		kfifo_skip(&rp->replay);
+		sample_record_unpack(&rec, &data[n++]);
+		rp->replayed++;
+	}
+
+	if (n) {
+		wake_up_interruptible(&rp->replay_wait);
+	} else if (READ_ONCE(rp->writer_done) && kfifo_is_empty(&rp->replay)) {
+		pr_info(MP "replay finished: %u samples\n", rp->replayed);
+		WRITE_ONCE(rp->replaying, false);
+	}
+
+	return n;
+}
+
+
+#pragma region /* Debugfs files */
+/* Single reader, capturing lasts while the file is open */
+static int capture_open(struct inode *inode, struct file *file)
+{
+	int ret = 0;
+	struct logic_replay *rp = inode->i_private;
+
+	mutex_lock(&rp->open_lock);
+
+	if (rp->capturing) {
+		ret = -EBUSY;
+	} else {
+		kfifo_reset_out(&rp->capture);
+		rp->capture_dropped = 0;
+		WRITE_ONCE(rp->capturing, true);
+	}
+
+	mutex_unlock(&rp->open_lock);
+
+	if (ret)
+		return ret;
+
+	file->private_data = rp;
+
+	return nonseekable_open(inode, file);
+}
+
+static int capture_release(struct inode *inode, struct file *file)
+{
+	struct logic_replay *rp = file->private_data;
+
+	WRITE_ONCE(rp->capturing, false);
+	if (rp->capture_dropped)
+		pr_warn(MP "capture dropped %u samples\n", rp->capture_dropped);
+
+	return 0;
+}
+
+static ssize_t capture_read(struct file *file, char __user *buf, size_t count,
+			    loff_t *ppos)
+{
+	int ret;
+	unsigned int copied;
+	struct logic_replay *rp = file->private_data;
+
+	if (count < sizeof(struct logic_sample_record))
+		return -EINVAL;
+
+	if (kfifo_is_empty(&rp->capture)) {
+		if (file->f_flags & O_NONBLOCK)
+			return -EAGAIN;
+
+		ret = wait_event_interruptible(rp->capture_wait,
+				!kfifo_is_empty(&rp->capture) ||
+				READ_ONCE(rp->closing));
+		if (ret)
+			return ret;
+		if (READ_ONCE(rp->closing))
+			return -ENODEV;
+	}
+
+	ret = kfifo_to_user(&rp->capture, buf, count, &copied);
+
+	return ret ? ret : copied;
+}
+
+static __poll_t capture_poll(struct file *file, poll_table *wait)
+{
+	struct logic_replay *rp = file->private_data;
+
+	poll_wait(file, &rp->capture_wait, wait);
+
+	return kfifo_is_empty(&rp->capture) ? 0 : EPOLLIN | EPOLLRDNORM;
+}
+
+const struct file_operations capture_fops = {
+	.owner = THIS_MODULE,
+	.open = capture_open,
+	.release = capture_release,
+	.read = capture_read,
+	.poll = capture_poll,
+	.llseek = no_llseek,
+};
+
+/* Single writer, a new replay can start once the previous one is drained */
+static int replay_open(struct inode *inode, struct file *file)
+{
+	int ret = 0;
+	struct logic_replay *rp = inode->i_private;
+
+	mutex_lock(&rp->open_lock);
+
+	/* The loop doesn't touch the queue until replaying is set */
+	if (READ_ONCE(rp->replaying)) {
+		ret = -EBUSY;
+	} else {
+		kfifo_reset(&rp->replay);
+		rp->replayed = 0;
+		rp->writer_done = false;
+		smp_store_release(&rp->replaying, true);
+	}
+
+	mutex_unlock(&rp->open_lock);
+
+	if (ret)
+		return ret;
+
+	file->private_data = rp;
+
+	rp->kick();
+
+	return nonseekable_open(inode, file);
+}
+
+static int replay_release(struct inode *inode, struct file *file)
+{
+	struct logic_replay *rp = file->private_data;
+
+	/* Queued samples are still played, then the sensor takes over */
+	WRITE_ONCE(rp->writer_done, true);
+	rp->kick();
+
+	return 0;
+}
+
+static ssize_t replay_write(struct file *file, const char __user *buf,
+			    size_t count, loff_t *ppos)
+{
+	int ret;
+	size_t done = 0;
+	struct logic_sample_record rec;
+	struct logic_replay *rp = file->private_data;
+
+	if (count < sizeof(rec))
+		return -EINVAL;
+
+	while (count - done >= sizeof(rec)) {
+		if (kfifo_is_full(&rp->replay)) {
+			/* Let the loop take what's already queued */
+			rp->kick();
+
+			if (done)
+				break;
+			if (file->f_flags & O_NONBLOCK)
+				return -EAGAIN;
+
+			ret = wait_event_interruptible(rp->replay_wait,
+					!kfifo_is_full(&rp->replay) ||
+					READ_ONCE(rp->closing));
+			if (ret)
+				return ret;
+			if (READ_ONCE(rp->closing))
+				return -ENODEV;
+		}
+
+		if (copy_from_user(&rec, buf + done, sizeof(rec)))
+			return done ? done : -EFAULT;
+
+		if (le16_to_cpu(rec.version) != SAMPLE_RECORD_VERSION ||
+		    le16_to_cpu(rec.size) != sizeof(rec))
+			return done ? done : -EINVAL;
+
+		kfifo_put(&rp->replay, rec);
+		done += sizeof(rec);
+	}
+
+	if (!READ_ONCE(rp->realtime))
+		rp->kick();
+
+	return done;
+}
+
+const struct file_operations replay_fops = {
+	.owner = THIS_MODULE,
+	.open = replay_open,
+	.release = replay_release,
+	.write = replay_write,
+	.llseek = no_llseek,
+};
+#pragma endregion
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/bitops.h>
+#include <linux/math64.h>
+#include <linux/ktime.h>
+#include "logic.h"
+
+#define FFT_INPUT_MAX	((1 << 14) - 1)	/* Headroom for the butterflies */
+
+static const char * const axis_names[3] = { "accel_x", "accel_y", "accel_z" };
+
+static inline s32 spectrum_windowed(const s16 *in, s32 dc, int i)
+{
+	return ((in[i] - dc) * fxpt_hann(i)) >> 15;
+}
+
+/*
+ * Removes DC, applies the window and normalizes the block to use
+ * the FFT dynamic range (block floating point).
+ *
+ * Returns the normalization shift.
+ */
+static int spectrum_condition(const s16 *in, s16 *re)
+{
+	int i, shift = 0;
+	s32 dc = 0, peak = 0, v;
+
+	for (i = 0; i < FXPT_FFT_SIZE; i++)
+		dc += in[i];
+	dc /= FXPT_FFT_SIZE;
+
+	for (i = 0; i < FXPT_FFT_SIZE; i++)
+		peak = max(peak, abs(spectrum_windowed(in, dc, i)));
+
+	while (peak && (peak << 1) <= FFT_INPUT_MAX) {
+		peak <<= 1;
+		shift++;
+	}
+	while (peak > FFT_INPUT_MAX) {
+		peak >>= 1;
+		shift--;
+	}
+
+	for (i = 0; i < FXPT_FFT_SIZE; i++) {
+		v = spectrum_windowed(in, dc, i);
+		re[i] = shift >= 0 ? v << shift : v >> -shift;
+	}
+
+	return shift;
+}
+
+static void spectrum_peak(struct spectrum_result *res, int a, int k, u64 pw)
+{
+	int p;
+
+	for (p = SPECTRUM_PEAKS - 1; p > 0 && pw > res->peak_power[a][p - 1];
+	     p--) {
+		res->peak_power[a][p] = res->peak_power[a][p - 1];
+		res->peak_bin[a][p] = res->peak_bin[a][p - 1];
+	}
+
+	res->peak_power[a][p] = pw;
+	res->peak_bin[a][p] = k;
+}
+
+static void spectrum_analyse(struct logic_spectrum *sp,
+			     struct spectrum_result *res)
+{
+	int a, k, shift;
+	u64 pw;
+	u32 mag[SPECTRUM_BINS + 1];
+	s16 re[FXPT_FFT_SIZE], im[FXPT_FFT_SIZE];
+
+	memset(res->peak_bin, 0, sizeof(res->peak_bin));
+	memset(res->peak_power, 0, sizeof(res->peak_power));
+	memset(res->band, 0, sizeof(res->band));
+	memset(res->power, 0, sizeof(res->power));
+
+	for (a = 0; a < 3; a++) {
+		shift = spectrum_condition(sp->win[a], re);
+		memset(im, 0, sizeof(im));
+
+		fxpt_fft(re, im);
+
+		/* Normalized |X[k]|^2, below 2^29 for 15 bit inputs */
+		for (k = 0; k <= SPECTRUM_BINS; k++)
+			mag[k] = re[k] * re[k] + im[k] * im[k];
+
+		/* Bin 0 is DC, removed while conditioning */
+		for (k = 1; k < SPECTRUM_BINS; k++) {
+			pw = shift >= 0 ? (u64)mag[k] >> (2 * shift)
+					: (u64)mag[k] << (-2 * shift);
+
+			res->power[k] += pw;
+			res->band[a][k * SPECTRUM_BANDS / SPECTRUM_BINS] += pw;
+
+			/* Keep the strongest local maxima */
+			if (pw > res->peak_power[a][SPECTRUM_PEAKS - 1] &&
+			    mag[k] >= mag[k - 1] && mag[k] >= mag[k + 1])
+				spectrum_peak(res, a, k, pw);
+		}
+	}
+}
+
+void spectrum_init(struct logic_spectrum *sp)
+{
+	spin_lock_init(&sp->lock);
+	spectrum_reset(sp, 0);
+}
+
+void spectrum_reset(struct logic_spectrum *sp, unsigned int rate)
+{
+	sp->fill = 0;
+
+	spin_lock(&sp->lock);
+	memset(&sp->res, 0, sizeof(sp->res));
+	sp->res.rate = rate;
+	spin_unlock(&sp->lock);
+}
+
+/**
+ * spectrum_feed() - add one sample to the spectrum window
+ * @sp: spectrum instance
+ * @accel: calibrated accelerometer x, y, z
+ * @ts: sampling instant
+ *
+ * Analyses the window once it's full. Windows do not overlap. Bin
+ * frequencies follow the rate measured over the window timestamps, the
+ * sensor clock may be a few percent off the nominal one.
+ *
+ * Return: true if a new spectrum has been published.
+ */
+bool spectrum_feed(struct logic_spectrum *sp, const s32 *accel, ktime_t ts)
+{
+	int a;
+	s64 span;
+	static struct spectrum_result res;	/* Too big for the stack */
+
+	if (!sp->fill)
+		sp->start = ts;
+
+	for (a = 0; a < 3; a++)
+		sp->win[a][sp->fill] = clamp_t(s32, accel[a], S16_MIN, S16_MAX);
+
+	if (++sp->fill < FXPT_FFT_SIZE)
+		return false;
+
+	sp->fill = 0;
+
+	spectrum_analyse(sp, &res);
+
+	span = ktime_to_ns(ktime_sub(ts, sp->start));
+	res.measured = span > 0 ? div64_u64((u64)(FXPT_FFT_SIZE - 1) *
+					    NSEC_PER_SEC * 1000, span) : 0;
+
+	spin_lock(&sp->lock);
+	res.rate = sp->res.rate;
+	res.windows = sp->res.windows + 1;
+	sp->res = res;
+	spin_unlock(&sp->lock);
+
+	return true;
+}
+
+void spectrum_get(struct logic_spectrum *sp, struct spectrum_result *res)
+{
+	spin_lock(&sp->lock);
+	*res = sp->res;
+	spin_unlock(&sp->lock);
+}
+
+/**
+ * spectrum_freq() - frequency of a bin
+ * @res: spectrum
+ * @k: bin
+ *
+ * Return: frequency in 0.1 Hz, at the measured rate if there is one.
+ */
+unsigned int spectrum_freq(const struct spectrum_result *res, int k)
+{
+	if (res->measured)
+		return div_u64((u64)k * res->measured, FXPT_FFT_SIZE * 100);
+
+	return k * res->rate * 10 / FXPT_FFT_SIZE;
+}
+
+/**
+ * spectrum_print() - format the latest spectrum as text
+ * @sp: spectrum instance
+ * @buf: output buffer
+ * @size: output buffer size
+ *
+ * Return: number of characters written.
+ */
+int spectrum_print(struct logic_spectrum *sp, char *buf, size_t size)
+{
+	int a, i, len;
+	unsigned int f;
+	static struct spectrum_result res;
+	static DEFINE_SPINLOCK(print_lock);	/* Protects res */
+
+	spin_lock(&print_lock);
+	spectrum_get(sp, &res);
+
+	len = scnprintf(buf, size, "rate: %u Hz (measured %u.%03u), window: %d samples, %u analysed\n",
+			res.rate, res.measured / 1000, res.measured % 1000,
+			FXPT_FFT_SIZE, res.windows);
+
+	for (a = 0; a < 3; a++) {
+		len += scnprintf(buf + len, size - len, "%s peaks:", axis_names[a]);
+		for (i = 0; i < SPECTRUM_PEAKS; i++) {
+			f = spectrum_freq(&res, res.peak_bin[a][i]);
+			len += scnprintf(buf + len, size - len, " %u.%u Hz (%llu)",
+					 f / 10, f % 10, res.peak_power[a][i]);
+		}
+		len += scnprintf(buf + len, size - len, "\n");
+	}
+
+	len += scnprintf(buf + len, size - len, "%-12s %10s %10s %10s\n",
+			 "band, Hz", axis_names[0], axis_names[1], axis_names[2]);
+
+	for (i = 0; i < SPECTRUM_BANDS; i++) {
+		f = spectrum_freq(&res, i * SPECTRUM_BINS / SPECTRUM_BANDS) / 10;
+		len += scnprintf(buf + len, size - len, "%5u-%-6u %10llu %10llu %10llu\n",
+				 f, spectrum_freq(&res, (i + 1) * SPECTRUM_BINS /
+					     SPECTRUM_BANDS) / 10,
+				 res.band[0][i], res.band[1][i], res.band[2][i]);
+	}
+
+	spin_unlock(&print_lock);
+
+	return len;
+}
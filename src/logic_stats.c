@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/spinlock.h>
+#include <linux/string.h>
+#include <linux/math64.h>
+#include <linux/overflow.h>
+#include "logic.h"
+
+static const char * const axis_names[AXIS_COUNT] = {
+	"accel_x", "accel_y", "accel_z", "gyro_x", "gyro_y", "gyro_z"
+};
+
+/* Welford's online update in fixed point, O(1) per sample */
+static void axis_update(struct axis_stats *a, s32 x)
+{
+	s64 xq = (s64)x << STATS_FRAC;
+	s64 delta = xq - a->mean;
+	u64 sq;
+
+	if (!a->count || x < a->min)
+		a->min = x;
+	if (!a->count || x > a->max)
+		a->max = x;
+
+	a->count++;
+	a->mean += div_s64(delta, a->count);
+
+	/*
+	 * Both factors have the same sign, so the product is never negative.
+	 * Kept unshifted, truncating every term would bias the variance low.
+	 */
+	sq = (u64)(delta * (xq - a->mean));
+	if (check_add_overflow(a->m2, sq, &a->m2))
+		a->m2 = U64_MAX;
+}
+
+static s32 axis_mean(const struct axis_stats *a)
+{
+	return (s32)((a->mean + (1 << (STATS_FRAC - 1))) >> STATS_FRAC);
+}
+
+static u64 axis_var(const struct axis_stats *a)
+{
+	u64 var;
+
+	if (a->count < 2)
+		return 0;
+
+	var = div_u64(a->m2, a->count - 1);
+
+	return (var + (1ULL << (2 * STATS_FRAC - 1))) >> (2 * STATS_FRAC);
+}
+
+void stats_init(struct logic_stats *st, u32 window)
+{
+	spin_lock_init(&st->lock);
+	st->window = window;
+	stats_reset(st);
+}
+
+void stats_reset(struct logic_stats *st)
+{
+	spin_lock(&st->lock);
+	st->windows = 0;
+	st->span = 0;
+	memset(st->cur, 0, sizeof(st->cur));
+	memset(st->last, 0, sizeof(st->last));
+	memset(st->life, 0, sizeof(st->life));
+	spin_unlock(&st->lock);
+}
+
+/**
+ * stats_update() - account one sample in windowed and lifetime stats
+ * @st: stats instance
+ * @v: calibrated sample, one value per axis (see enum logic_axis)
+ * @ts: sampling instant
+ */
+void stats_update(struct logic_stats *st, const s32 *v, ktime_t ts)
+{
+	int i;
+
+	spin_lock(&st->lock);
+
+	if (!st->cur[0].count)
+		st->start = ts;
+
+	for (i = 0; i < AXIS_COUNT; i++) {
+		axis_update(&st->cur[i], v[i]);
+		axis_update(&st->life[i], v[i]);
+	}
+
+	if (st->cur[0].count >= READ_ONCE(st->window)) {
+		memcpy(st->last, st->cur, sizeof(st->last));
+		memset(st->cur, 0, sizeof(st->cur));
+		st->span = ktime_to_ns(ktime_sub(ts, st->start));
+		st->windows++;
+	}
+
+	spin_unlock(&st->lock);
+}
+
+static int axis_print(char *buf, size_t size, const char *axis,
+		      const char *scope, const struct axis_stats *a)
+{
+	return scnprintf(buf, size, "%-8s %-9s %10u %7d %10llu %7d %7d %7d\n",
+			 axis, scope, a->count, axis_mean(a), axis_var(a),
+			 a->min, a->max, a->max - a->min);
+}
+
+/**
+ * stats_print() - format stats snapshot as a text table
+ * @st: stats instance
+ * @buf: output buffer
+ * @size: output buffer size
+ *
+ * Return: number of characters written.
+ */
+int stats_print(struct logic_stats *st, char *buf, size_t size)
+{
+	int i, len;
+	u32 window, windows, mhz = 0;
+	s64 span;
+	struct axis_stats last[AXIS_COUNT], life[AXIS_COUNT];
+
+	spin_lock(&st->lock);
+	window = st->window;
+	windows = st->windows;
+	span = st->span;
+	memcpy(last, st->last, sizeof(last));
+	memcpy(life, st->life, sizeof(life));
+	spin_unlock(&st->lock);
+
+	/* Rate the last window was actually sampled at */
+	if (span > 0 && last[0].count > 1)
+		mhz = div64_u64((u64)(last[0].count - 1) * NSEC_PER_SEC * 1000,
+				span);
+
+	len = scnprintf(buf, size, "window: %u samples, %u completed, last %lld us at %u.%03u Hz\n",
+			window, windows, div_s64(span, NSEC_PER_USEC),
+			mhz / 1000, mhz % 1000);
+	len += scnprintf(buf + len, size - len,
+			 "%-8s %-9s %10s %7s %10s %7s %7s %7s\n", "axis",
+			 "scope", "count", "mean", "variance", "min", "max",
+			 "p2p");
+
+	for (i = 0; i < AXIS_COUNT; i++) {
+		len += axis_print(buf + len, size - len, axis_names[i],
+				  "window", &last[i]);
+		len += axis_print(buf + len, size - len, axis_names[i],
+				  "lifetime", &life[i]);
+	}
+
+	return len;
+}
@@ -2,43 +2,77 @@
 
 #include <linux/errno.h>
 #include "logic.h"
+#include "logic_trace.h"
 
-int switch_mode(struct logic_state *state, struct logic_mode *mode)
+/*
+ * Mode switching is a single-slot mailbox: producers (button IRQ, sysfs)
+ * only post the requested mode id, the work loop is the only consumer
+ * and the only one who touches state->mode. The latest request wins.
+ */
+int switch_mode(struct logic_state *state, int mode)
 {
-	if (state->switching)
-		return -EPERM;	// Already switching
+	if (mode < 0 || mode >= state->mode_count)
+		return -EINVAL;
 
-	if (state->mode == mode)
-		return -EINVAL;	// Skipping switch to the same mode
-
-	state->switching = true;
-	state->mode = mode;
+	atomic_set(&state->pending_mode, mode);
+	atomic_inc(&state->requests);
 
 	return 0;
 }
 
 int next_mode(struct logic_state *state)
 {
-	state->current_mode += 1;
+	int mode;
+
+	mode = atomic_read(&state->pending_mode);
+	if (mode == LOGIC_MODE_NONE)
+		mode = READ_ONCE(state->current_mode);
+
+	mode += 1;
 
-	if (state->current_mode >= state->mode_count - state->hidden_modes)
-		state->current_mode = 0;
+	if (mode >= state->mode_count - state->hidden_modes)
+		mode = 0;
 
-	return state->current_mode;
+	return mode;
 }
 
 int process_state(struct logic_state *state)
 {
-	if (!state || !state->mode)
+	int mode, ret;
+
+	if (!state || !state->modes)
 		return -EFAULT;
 
-	if (state->switching) {
-		state->mode->prepare(state->mode);
-		state->switching = false;
+	mode = atomic_xchg(&state->pending_mode, LOGIC_MODE_NONE);
+
+	/* Skipping switch to the same mode */
+	if (mode != LOGIC_MODE_NONE &&
+	    (!state->mode || mode != state->current_mode)) {
+		if (state->mode && state->mode->release)
+			state->mode->release(state->mode);
+
+		trace_logic_mode_switch(state->mode ? state->current_mode :
+					LOGIC_MODE_NONE, mode);
 
-		return 0;
+		WRITE_ONCE(state->current_mode, mode);
+		state->mode = &state->modes[mode];
+
+		/* Processing and rendering follow with the next batch */
+		state->switched = true;
+
+		trace_logic_prepare_enter(mode);
+		ret = 0;
+		if (state->mode->prepare)
+			ret = state->mode->prepare(state->mode);
+		trace_logic_prepare_exit(mode, ret);
 	}
-	state->mode->cycle(state->mode);
+
+	if (!state->mode)
+		return -EFAULT;
+
+	/* Samples go down the pipeline, failures are retried next cycle */
+	if (state->acquire)
+		state->acquire(state);
 
 	return 0;
 }
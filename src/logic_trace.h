@@ -0,0 +1,131 @@
+/* SPDX-License-Identifier: GPL */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM bc_logic
+
+#if !defined(__LOGIC_TRACE_H__) || defined(TRACE_HEADER_MULTI_READ)
+#define __LOGIC_TRACE_H__
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(logic_mode_switch,
+
+	TP_PROTO(int from, int to),
+
+	TP_ARGS(from, to),
+
+	TP_STRUCT__entry(
+		__field(int, from)
+		__field(int, to)
+	),
+
+	TP_fast_assign(
+		__entry->from = from;
+		__entry->to = to;
+	),
+
+	TP_printk("from=%d to=%d", __entry->from, __entry->to)
+);
+
+DECLARE_EVENT_CLASS(logic_mode_enter,
+
+	TP_PROTO(int mode),
+
+	TP_ARGS(mode),
+
+	TP_STRUCT__entry(
+		__field(int, mode)
+	),
+
+	TP_fast_assign(
+		__entry->mode = mode;
+	),
+
+	TP_printk("mode=%d", __entry->mode)
+);
+
+DEFINE_EVENT(logic_mode_enter, logic_prepare_enter,
+	TP_PROTO(int mode),
+	TP_ARGS(mode)
+);
+
+DEFINE_EVENT(logic_mode_enter, logic_cycle_enter,
+	TP_PROTO(int mode),
+	TP_ARGS(mode)
+);
+
+DECLARE_EVENT_CLASS(logic_mode_exit,
+
+	TP_PROTO(int mode, int ret),
+
+	TP_ARGS(mode, ret),
+
+	TP_STRUCT__entry(
+		__field(int, mode)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__entry->mode = mode;
+		__entry->ret = ret;
+	),
+
+	TP_printk("mode=%d ret=%d", __entry->mode, __entry->ret)
+);
+
+DEFINE_EVENT(logic_mode_exit, logic_prepare_exit,
+	TP_PROTO(int mode, int ret),
+	TP_ARGS(mode, ret)
+);
+
+DEFINE_EVENT(logic_mode_exit, logic_cycle_exit,
+	TP_PROTO(int mode, int ret),
+	TP_ARGS(mode, ret)
+);
+
+TRACE_EVENT(logic_button_irq,
+
+	TP_PROTO(int irq, bool accepted),
+
+	TP_ARGS(irq, accepted),
+
+	TP_STRUCT__entry(
+		__field(int, irq)
+		__field(bool, accepted)
+	),
+
+	TP_fast_assign(
+		__entry->irq = irq;
+		__entry->accepted = accepted;
+	),
+
+	TP_printk("irq=%d accepted=%d", __entry->irq, __entry->accepted)
+);
+
+TRACE_EVENT(logic_latency,
+
+	TP_PROTO(int mode, s64 us),
+
+	TP_ARGS(mode, us),
+
+	TP_STRUCT__entry(
+		__field(int, mode)
+		__field(s64, us)
+	),
+
+	TP_fast_assign(
+		__entry->mode = mode;
+		__entry->us = us;
+	),
+
+	TP_printk("mode=%d us=%lld", __entry->mode, __entry->us)
+);
+
+#endif /* __LOGIC_TRACE_H__ */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE logic_trace
+#include <trace/define_trace.h>
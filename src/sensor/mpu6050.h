@@ -8,12 +8,21 @@
 #define MPU6050_DATA_ADDR	0x3B
 #define MPU6050_DATA_SIZE	14
 
+#define MPU6050_FIFO_SIZE	1024
+#define MPU6050_GYRO_RATE	1000	/* Gyro output rate with DLPF enabled */
+#define MPU6050_GYRO_START_MS	30	/* Gyro start-up time from sleep */
+#define MPU6050_MOT_THR_MG	2	/* Motion threshold LSB, mg */
+
+#define REG_SMPLRT_DIV		0x19
 #define REG_CONFIG		0x1A
 #define REG_GYRO_CONFIG		0x1B
 #define REG_ACCEL_CONFIG	0x1C
+#define REG_MOT_THR		0x1F
+#define REG_MOT_DUR		0x20
 #define REG_FIFO_EN		0x23
 #define REG_INT_PIN_CFG		0x37
 #define REG_INT_ENABLE		0x38
+#define REG_INT_STATUS		0x3A
 #define REG_ACCEL_XOUT_H	0x3B
 #define REG_ACCEL_XOUT_L	0x3C
 #define REG_ACCEL_YOUT_H	0x3D
@@ -31,6 +40,47 @@
 #define REG_USER_CTRL		0x6A
 #define REG_PWR_MGMT_1		0x6B
 #define REG_PWR_MGMT_2		0x6C
+#define REG_FIFO_COUNT_H	0x72
+#define REG_FIFO_COUNT_L	0x73
+#define REG_FIFO_R_W		0x74
 #define REG_WHO_AM_I		0x75
 
+/* REG_FIFO_EN bits */
+#define FIFO_EN_TEMP		0x80
+#define FIFO_EN_XG		0x40
+#define FIFO_EN_YG		0x20
+#define FIFO_EN_ZG		0x10
+#define FIFO_EN_ACCEL		0x08
+#define FIFO_EN_ALL		(FIFO_EN_TEMP | FIFO_EN_XG | FIFO_EN_YG | \
+				 FIFO_EN_ZG | FIFO_EN_ACCEL)
+
+/* REG_ACCEL_CONFIG bits */
+#define ACCEL_CONFIG_HPF_5HZ	0x01	/* High pass filter of motion detector */
+
+/* REG_INT_PIN_CFG bits */
+#define INT_PIN_CFG_LATCH_EN	0x20	/* Held until INT_STATUS is read */
+
+/* REG_INT_ENABLE and REG_INT_STATUS bits */
+#define INT_MOT			0x40
+#define INT_DATA_RDY		0x01
+
+/* REG_USER_CTRL bits */
+#define USER_CTRL_FIFO_EN	0x40
+#define USER_CTRL_FIFO_RESET	0x04
+
+/* REG_PWR_MGMT_1 bits */
+#define PWR1_SLEEP		0x40
+#define PWR1_CYCLE		0x20
+#define PWR1_TEMP_DIS		0x08
+
+/* REG_PWR_MGMT_2 bits */
+#define PWR2_LP_WAKE_1_25HZ	0x00	/* Accel wake-up rate in cycle mode */
+#define PWR2_LP_WAKE_5HZ	0x40
+#define PWR2_LP_WAKE_20HZ	0x80
+#define PWR2_LP_WAKE_40HZ	0xC0
+#define PWR2_STBY_XG		0x04
+#define PWR2_STBY_YG		0x02
+#define PWR2_STBY_ZG		0x01
+#define PWR2_STBY_G		(PWR2_STBY_XG | PWR2_STBY_YG | PWR2_STBY_ZG)
+
 #endif /* __MPU6050_H__ */
@@ -0,0 +1,19 @@
+/* SPDX-License-Identifier: GPL */
+
+#ifndef __MPU6050_BUS_H__
+#define __MPU6050_BUS_H__
+
+#include <linux/types.h>
+
+/* Register access backend: real chip on I2C or software simulation */
+struct mpu6050_bus {
+	const char *name;
+	int (*read)(u8 reg, u8 *buf, u16 len);	/* Burst read, 0 on success */
+	int (*write)(u8 reg, u8 value);
+};
+
+extern const struct mpu6050_bus mpu6050_sim_bus;
+
+void mpu6050_sim_reset(void);
+
+#endif /* __MPU6050_BUS_H__ */
@@ -0,0 +1,297 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/kernel.h>
+#include <linux/module.h>
+#include <linux/moduleparam.h>
+#include <linux/mutex.h>
+#include <linux/ktime.h>
+#include <linux/delay.h>
+#include <linux/hash.h>
+#include <linux/math64.h>
+#include <linux/fixp-arith.h>
+
+#include "mpu6050.h"
+#include "mpu6050_bus.h"
+
+/*
+ * Software MPU-6050 behind the register interface of the driver, so the
+ * whole pipeline runs without hardware. Samples are a function of time:
+ * static tilt, sinusoidal vibration along Z, noise and gyro Z drift.
+ * Sample k is the same whether it is read from the data registers or from
+ * the FIFO, noise is a hash of the sample index and the axis.
+ */
+
+#define SIM_REGS		0x80
+#define SIM_ACCEL_1G		16384	/* LSB, +-2 g full scale */
+#define SIM_GYRO_1DPS		131	/* LSB, +-250 dps full scale */
+#define SIM_TEMP_25C		(-3920)	/* (25 - 36.53) * 340 */
+
+static int sim_tilt_x;
+module_param(sim_tilt_x, int, 0644);
+MODULE_PARM_DESC(sim_tilt_x, "Simulated tilt around Y axis, degrees");
+
+static int sim_tilt_y;
+module_param(sim_tilt_y, int, 0644);
+MODULE_PARM_DESC(sim_tilt_y, "Simulated tilt around X axis, degrees");
+
+static unsigned int sim_vib_freq;
+module_param(sim_vib_freq, uint, 0644);
+MODULE_PARM_DESC(sim_vib_freq, "Simulated vibration frequency, Hz");
+
+static unsigned int sim_vib_amp;
+module_param(sim_vib_amp, uint, 0644);
+MODULE_PARM_DESC(sim_vib_amp, "Simulated vibration amplitude along Z, mg");
+
+static unsigned int sim_noise;
+module_param(sim_noise, uint, 0644);
+MODULE_PARM_DESC(sim_noise, "Simulated noise amplitude, LSB");
+
+static int sim_gyro_drift;
+module_param(sim_gyro_drift, int, 0644);
+MODULE_PARM_DESC(sim_gyro_drift, "Simulated gyro Z drift, mdps/s");
+
+static unsigned int sim_latency_us = 100;
+module_param(sim_latency_us, uint, 0644);
+MODULE_PARM_DESC(sim_latency_us, "Simulated bus latency per transfer, us");
+
+static unsigned int sim_byte_ns = 22500;
+module_param(sim_byte_ns, uint, 0644);
+MODULE_PARM_DESC(sim_byte_ns, "Simulated bus time per byte, ns (400 kHz)");
+
+static int sim_clock_ppm;
+module_param(sim_clock_ppm, int, 0644);
+MODULE_PARM_DESC(sim_clock_ppm, "Simulated sample clock error, ppm");
+
+static DEFINE_MUTEX(sim_lock);		/* Protects everything below */
+static u8 regs[SIM_REGS];
+static ktime_t sim_t0;			/* Time of sample 0 */
+static ktime_t fifo_t0;			/* Time of the first FIFO sample */
+static u64 fifo_pos;			/* Bytes popped since fifo_t0 */
+
+static inline u32 sim_period_us(void)
+{
+	return USEC_PER_MSEC * (1 + regs[REG_SMPLRT_DIV]);
+}
+
+/* Real time between samples, the oscillator is sim_clock_ppm fast */
+static inline u64 sim_period_ns(void)
+{
+	int ppm = clamp(READ_ONCE(sim_clock_ppm), -100000, 100000);
+
+	return div_u64((u64)sim_period_us() * NSEC_PER_USEC * USEC_PER_SEC,
+		       USEC_PER_SEC + ppm);
+}
+
+/* Samples taken between @t0 and @t */
+static inline u64 sim_samples(ktime_t t0, ktime_t t)
+{
+	return div64_u64(ktime_to_ns(ktime_sub(t, t0)), sim_period_ns());
+}
+
+static inline bool sim_fifo_enabled(void)
+{
+	return (regs[REG_USER_CTRL] & USER_CTRL_FIFO_EN) &&
+	       regs[REG_FIFO_EN] == FIFO_EN_ALL;
+}
+
+static s16 sim_noise_lsb(u64 k, int axis)
+{
+	u32 noise = READ_ONCE(sim_noise);
+
+	if (!noise)
+		return 0;
+
+	return (s32)(hash_32((u32)k ^ (axis << 24), 32) % (2 * noise + 1)) -
+	       noise;
+}
+
+static void sim_put(u8 *p, s32 v)
+{
+	v = clamp_t(s32, v, S16_MIN, S16_MAX);
+	p[0] = v >> 8;
+	p[1] = v;
+}
+
+/* Frame of sample @k, register layout of MPU6050_DATA_ADDR */
+static void sim_sample(u64 k, u32 period_us, u8 *frame)
+{
+	u64 t_us = k * period_us;
+	int tx = READ_ONCE(sim_tilt_x), ty = READ_ONCE(sim_tilt_y);
+	u32 freq = READ_ONCE(sim_vib_freq);
+	s32 cos_x = fixp_cos32(tx);
+	s32 ax, ay, az, vib = 0;
+	s64 gz;
+
+	/* Gravity vector of the tilted device, fixp values are Q31 */
+	ax = ((s64)SIM_ACCEL_1G * fixp_sin32(tx)) >> 31;
+	ay = ((s64)SIM_ACCEL_1G * fixp_sin32(ty) >> 31) * cos_x >> 31;
+	az = ((s64)SIM_ACCEL_1G * fixp_cos32(ty) >> 31) * cos_x >> 31;
+
+	if (freq) {
+		u32 phase;
+
+		/* Phase in millionths of the vibration period */
+		div_u64_rem(t_us * freq, USEC_PER_SEC, &phase);
+		vib = ((s64)READ_ONCE(sim_vib_amp) * SIM_ACCEL_1G / 1000 *
+		       fixp_sin32_rad(phase, USEC_PER_SEC)) >> 31;
+	}
+
+	gz = div_s64((s64)READ_ONCE(sim_gyro_drift) * SIM_GYRO_1DPS *
+		     (s64)t_us, 1000 * USEC_PER_SEC);
+
+	sim_put(&frame[0], ax + sim_noise_lsb(k, 0));
+	sim_put(&frame[2], ay + sim_noise_lsb(k, 1));
+	sim_put(&frame[4], az + vib + sim_noise_lsb(k, 2));
+	sim_put(&frame[6], SIM_TEMP_25C);
+	sim_put(&frame[8], sim_noise_lsb(k, 3));
+	sim_put(&frame[10], sim_noise_lsb(k, 4));
+	sim_put(&frame[12], gz + sim_noise_lsb(k, 5));
+}
+
+static void sim_fifo_reset(ktime_t now)
+{
+	fifo_t0 = now;
+	fifo_pos = 0;
+}
+
+/* Bytes the FIFO holds now, saturates like the real one */
+static u32 sim_fifo_count(ktime_t now)
+{
+	u64 frames, bytes;
+
+	if (!sim_fifo_enabled())
+		return 0;
+
+	frames = sim_samples(fifo_t0, now);
+	bytes = frames * MPU6050_DATA_SIZE;
+	if (bytes <= fifo_pos)
+		return 0;
+
+	return min_t(u64, bytes - fifo_pos, MPU6050_FIFO_SIZE);
+}
+
+static void sim_fifo_pop(u8 *buf, u16 len)
+{
+	u8 frame[MPU6050_DATA_SIZE];
+	u32 period = sim_period_us();
+	u64 k, base = sim_samples(sim_t0, fifo_t0);
+	u32 off, n;
+	u16 i = 0;
+
+	while (i < len) {
+		k = div_u64_rem(fifo_pos, MPU6050_DATA_SIZE, &off);
+		sim_sample(base + k, period, frame);
+		n = min_t(u32, MPU6050_DATA_SIZE - off, len - i);
+		memcpy(&buf[i], &frame[off], n);
+		i += n;
+		fifo_pos += n;
+	}
+}
+
+/* Refreshes data and FIFO count registers */
+static void sim_update(ktime_t now)
+{
+	u32 period = sim_period_us();
+	u64 k = sim_samples(sim_t0, now);
+	u32 count = sim_fifo_count(now);
+
+	if (!(regs[REG_PWR_MGMT_1] & PWR1_SLEEP))
+		sim_sample(k, period, &regs[MPU6050_DATA_ADDR]);
+
+	regs[REG_FIFO_COUNT_H] = count >> 8;
+	regs[REG_FIFO_COUNT_L] = count;
+}
+
+/* Start and address bytes plus payload */
+static void sim_delay(u16 len)
+{
+	u32 us = READ_ONCE(sim_latency_us) +
+		 div_u64((u64)(len + 2) * READ_ONCE(sim_byte_ns),
+			 NSEC_PER_USEC);
+
+	if (us >= 10)
+		usleep_range(us, us + us / 4);
+	else if (us)
+		udelay(us);
+}
+
+static int sim_read(u8 reg, u8 *buf, u16 len)
+{
+	if (reg != REG_FIFO_R_W && reg + len > SIM_REGS)
+		return -EINVAL;
+
+	sim_delay(len);
+
+	mutex_lock(&sim_lock);
+
+	if (reg == REG_FIFO_R_W) {
+		/* Reads past the count get the next samples early */
+		sim_fifo_pop(buf, len);
+	} else {
+		sim_update(ktime_get());
+		memcpy(buf, &regs[reg], len);
+	}
+
+	mutex_unlock(&sim_lock);
+
+	return 0;
+}
+
+static int sim_write(u8 reg, u8 value)
+{
+	ktime_t now = ktime_get();
+
+	if (reg >= SIM_REGS)
+		return -EINVAL;
+
+	sim_delay(1);
+
+	mutex_lock(&sim_lock);
+
+	switch (reg) {
+	case REG_USER_CTRL:
+		if (value & USER_CTRL_FIFO_RESET)
+			sim_fifo_reset(now);
+		value &= ~USER_CTRL_FIFO_RESET;	/* Self-clearing */
+		fallthrough;
+	case REG_FIFO_EN:
+	case REG_SMPLRT_DIV:
+		/* Sampling starts over */
+		if (regs[reg] != value)
+			sim_fifo_reset(now);
+		break;
+	case REG_WHO_AM_I:
+	case REG_FIFO_R_W:
+		value = regs[reg];
+		break;
+	}
+
+	regs[reg] = value;
+
+	mutex_unlock(&sim_lock);
+
+	return 0;
+}
+
+/**
+ * mpu6050_sim_reset() - put the simulated device into power-on state
+ */
+void mpu6050_sim_reset(void)
+{
+	mutex_lock(&sim_lock);
+
+	memset(regs, 0, sizeof(regs));
+	regs[REG_PWR_MGMT_1] = PWR1_SLEEP;
+	regs[REG_WHO_AM_I] = MPU6050_I2C_ADDR;
+
+	sim_t0 = ktime_get();
+	sim_fifo_reset(sim_t0);
+
+	mutex_unlock(&sim_lock);
+}
+
+const struct mpu6050_bus mpu6050_sim_bus = {
+	.name = "simulated",
+	.read = sim_read,
+	.write = sim_write,
+};
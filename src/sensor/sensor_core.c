@@ -0,0 +1,1322 @@
+// SPDX-License-Identifier: GPL
+
+#include <linux/init.h>
+#include <linux/module.h>
+#include <linux/device.h>
+#include <linux/types.h>
+#include <linux/err.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <linux/math.h>
+#include <linux/mutex.h>
+#include <linux/atomic.h>
+#include <linux/ktime.h>
+#include <linux/pm_runtime.h>
+#include <linux/gpio.h>
+#include <linux/interrupt.h>
+#include <linux/spinlock.h>
+#include <linux/delay.h>
+#include <linux/math64.h>
+#include <asm/unaligned.h>
+#include <linux/platform_device.h>
+
+#include "sensor_module.h"
+#include "mpu6050_bus.h"
+#include "bus/bus_module.h"
+
+#define CREATE_TRACE_POINTS
+#include "sensor_trace.h"
+
+#define MP KBUILD_MODNAME ": "		/* Log Message Prefix */
+
+#define I2C_BUS 1			/* I2C bus number */
+#define I2C_DEVICE_NAME "bc-mpu6050"	/* Our device driver name */
+#define SIM_DEVICE_NAME "bc-mpu6050-sim"
+#define INT_IRQ_LABEL "bc-mpu6050: motion"
+
+#define DEFAULT_AUTOSUSPEND_MS	250	/* Idle time before cycle mode */
+
+#define SENSOR_RETRIES		3	/* Transfer retries before reinit */
+#define SENSOR_BACKOFF_US	100	/* First retry delay, doubled each */
+
+#define FIFO_CLK_FRAC		8	/* Fraction bits of the period, ns */
+#define FIFO_CLK_GAIN		4	/* log2 of the tracking filter length */
+#define FIFO_CLK_MIN_FRAMES	128	/* Shortest baseline of a period sample */
+#define FIFO_CLK_TOLERANCE	20	/* Period samples off by 1/x are lost */
+
+/* Accel keeps sampling in cycle mode, gyro and temperature are off */
+#define LP_PWR_MGMT_1		(PWR1_CYCLE | PWR1_TEMP_DIS)
+#define LP_PWR_MGMT_2		(PWR2_LP_WAKE_20HZ | PWR2_STBY_G)
+
+static int autosuspend_ms = DEFAULT_AUTOSUSPEND_MS;
+module_param(autosuspend_ms, int, 0444);
+MODULE_PARM_DESC(autosuspend_ms,
+		 "Idle time before low-power cycle mode, ms (-1 to disable)");
+
+static int int_pin = -1;
+module_param(int_pin, int, 0444);
+MODULE_PARM_DESC(int_pin, "GPIO pin wired to the INT output (-1 - none)");
+
+static bool sim;
+module_param(sim, bool, 0444);
+MODULE_PARM_DESC(sim, "Use the simulated sensor instead of the I2C chip");
+
+struct i2c_client *mpu6050_client;
+static struct platform_device *sim_pdev;
+
+/* Bound device and its register access backend */
+static struct device *mpu6050_dev;
+static const struct mpu6050_bus *bus;
+
+static DEFINE_MUTEX(fifo_lock);		/* Serializes FIFO users */
+static bool fifo_active;		/* FIFO holds the device awake */
+static atomic_t fifo_resets = ATOMIC_INIT(0);	/* Reinit FIFO resets */
+static atomic_t sample_seq = ATOMIC_INIT(0);
+
+/* Taken after fifo_lock if both are needed */
+static DEFINE_MUTEX(motion_lock);	/* Serializes motion interrupt setup */
+static void (*motion_handler)(void);
+static int int_irq = -1;
+
+/* Register configuration restored on resume */
+static struct {
+	u8 config;
+	u8 smplrt_div;
+	u8 fifo_en;
+	u8 accel_config;
+	u8 mot_thr;
+	u8 mot_dur;
+	u8 int_enable;
+} mpu6050_cfg;
+static u8 fifo_buf[MPU6050_FIFO_SIZE];
+
+/*
+ * Sample clock model, all under fifo_lock. Frame k after the FIFO reset
+ * was sampled at anchor_t + (k - anchor_k) * period.
+ */
+static struct {
+	unsigned int rate;		/* Programmed rate, Hz */
+	u64 nominal;			/* Programmed period, ns << FRAC */
+	u64 period;			/* Estimated period, ns << FRAC */
+	u64 consumed;			/* Frames read since the reset */
+	u64 produced;			/* Frames in the FIFO ever, last seen */
+	u64 anchor_k;
+	ktime_t anchor_t;
+	u64 base_k;			/* Start of the period baseline */
+	ktime_t base_t;			/* 0 until the first observation */
+	ktime_t last;			/* Latest timestamp handed out */
+	int resets_seen;		/* fifo_resets the timeline follows */
+	u32 restarts;
+} fifo_clk;
+
+static DEFINE_SPINLOCK(health_lock);
+static struct sensor_health mpu6050_health;
+
+static int mpu6050_setup(u8 pwr1, u8 pwr2);
+
+/* Digital low pass filter configs and their accel bandwidth in Hz */
+static const struct {
+	u8 cfg;
+	unsigned int bw;
+} dlpf_bw[] = {
+	{ 1, 184 }, { 2, 94 }, { 3, 44 }, { 4, 21 }, { 5, 10 }, { 6, 5 },
+};
+
+static int mpu6050_i2c_read(u8 reg, u8 *buf, u16 len)
+{
+	int ret;
+	struct i2c_msg msgs[] = {
+		{
+			.addr = mpu6050_client->addr,
+			.len = 1,
+			.buf = &reg,
+		},
+		{
+			.addr = mpu6050_client->addr,
+			.flags = I2C_M_RD,
+			.len = len,
+			.buf = buf,
+		},
+	};
+
+	bc_bus_get(BC_BUS_SENSOR);
+
+	if (len <= I2C_SMBUS_BLOCK_MAX) {
+		ret = i2c_smbus_read_i2c_block_data(mpu6050_client, reg, len,
+						    buf);
+		if (ret >= 0)
+			ret = ret == len ? 0 : -EIO;
+	} else {
+		/* FIFO bursts don't fit into an SMBus block */
+		ret = i2c_transfer(mpu6050_client->adapter, msgs,
+				   ARRAY_SIZE(msgs));
+		if (ret >= 0)
+			ret = ret == ARRAY_SIZE(msgs) ? 0 : -EIO;
+	}
+
+	bc_bus_put(BC_BUS_SENSOR, len);
+
+	return ret;
+}
+
+static int mpu6050_i2c_write(u8 reg, u8 value)
+{
+	int ret;
+
+	bc_bus_get(BC_BUS_SENSOR);
+	ret = i2c_smbus_write_byte_data(mpu6050_client, reg, value);
+	bc_bus_put(BC_BUS_SENSOR, 1);
+
+	return ret;
+}
+
+static const struct mpu6050_bus mpu6050_i2c_bus = {
+	.name = "i2c",
+	.read = mpu6050_i2c_read,
+	.write = mpu6050_i2c_write,
+};
+
+static inline int mpu6050_read(u8 reg, u8 *buf, u16 len)
+{
+	return bus->read(reg, buf, len);
+}
+
+static inline int mpu6050_write(u8 reg, u8 value)
+{
+	return bus->write(reg, value);
+}
+
+/* Wakes the device up for a bus access */
+static int mpu6050_get(void)
+{
+	int ret;
+
+	if (mpu6050_dev == NULL) {
+		pr_err(MP "mpu6050 device not found!");
+		return -ENODEV;
+	}
+
+	ret = pm_runtime_resume_and_get(mpu6050_dev);
+	if (ret < 0)
+		dev_err(mpu6050_dev, "cannot resume: %d\n", ret);
+
+	return ret;
+}
+
+static void mpu6050_put(void)
+{
+	pm_runtime_mark_last_busy(mpu6050_dev);
+	pm_runtime_put_autosuspend(mpu6050_dev);
+}
+
+static void mpu6050_error(int err)
+{
+	spin_lock(&health_lock);
+	mpu6050_health.errors++;
+	mpu6050_health.last_error = err;
+	if (mpu6050_health.state == SENSOR_OK)
+		mpu6050_health.state = SENSOR_RECOVERING;
+	spin_unlock(&health_lock);
+}
+
+static void mpu6050_healthy(void)
+{
+	if (READ_ONCE(mpu6050_health.state) == SENSOR_OK)
+		return;
+
+	spin_lock(&health_lock);
+	mpu6050_health.state = SENSOR_OK;
+	spin_unlock(&health_lock);
+}
+
+/*
+ * Runs the probe register sequence again, the device is held awake. It
+ * rewrites the FIFO and the motion registers, so it excludes their users.
+ * @fifo_held: the caller holds fifo_lock
+ */
+static int mpu6050_reinit(bool fifo_held)
+{
+	int ret;
+
+	spin_lock(&health_lock);
+	mpu6050_health.reinits++;
+	spin_unlock(&health_lock);
+
+	if (!fifo_held)
+		mutex_lock(&fifo_lock);
+	mutex_lock(&motion_lock);
+
+	ret = mpu6050_setup(0, 0);
+
+	mutex_unlock(&motion_lock);
+	if (!fifo_held)
+		mutex_unlock(&fifo_lock);
+
+	if (ret < 0)
+		dev_err(mpu6050_dev, "reinit failed: %d\n", ret);
+	else
+		dev_warn(mpu6050_dev, "reinitialized after errors\n");
+
+	return ret;
+}
+
+/*
+ * Bus error recovery: a failed transfer is retried with exponential
+ * backoff. When the retries run out the chip is re-initialized and the
+ * transfer gets one last chance. @fifo_held tells if the caller holds
+ * fifo_lock.
+ *
+ * Return: true if the transfer should be retried.
+ */
+static bool mpu6050_recover(int err, int attempt, bool fifo_held)
+{
+	unsigned long delay = SENSOR_BACKOFF_US << attempt;
+
+	mpu6050_error(err);
+
+	if (attempt < SENSOR_RETRIES) {
+		spin_lock(&health_lock);
+		mpu6050_health.retries++;
+		spin_unlock(&health_lock);
+
+		usleep_range(delay, delay * 2);
+		return true;
+	}
+
+	if (attempt == SENSOR_RETRIES && !mpu6050_reinit(fifo_held))
+		return true;
+
+	spin_lock(&health_lock);
+	mpu6050_health.failures++;
+	mpu6050_health.state = SENSOR_FAILED;
+	spin_unlock(&health_lock);
+
+	return false;
+}
+
+/* Big-endian register pair, returned as non-negative value on success */
+static int mpu6050_read_word(u8 reg, bool fifo_held)
+{
+	int ret, attempt = 0;
+	u8 buf[2];
+
+	do {
+		trace_sensor_read_start(reg, 2);
+		ret = mpu6050_read(reg, buf, 2);
+		trace_sensor_read_end(reg, 2, ret);
+	} while (ret < 0 && mpu6050_recover(ret, attempt++, fifo_held));
+
+	if (ret < 0)
+		return ret;
+
+	mpu6050_healthy();
+
+	return (buf[0] << 8) | buf[1];
+}
+
+/**
+ * bc_sensor_decode() - decode data register frames
+ * @frames: @count frames, MPU6050_DATA_SIZE bytes each, as read from
+ *	    the data registers or the FIFO
+ * @count: number of frames
+ * @data: array of @count data structures to fill, seq and timestamp
+ *	  are left untouched
+ *
+ * Frames are big-endian words, every word is loaded and swapped at once
+ * rather than assembled from bytes, with no branches in the loop.
+ */
+void bc_sensor_decode(const u8 *frames, int count, struct sensor_data *data)
+{
+	int i;
+
+	for (i = 0; i < count; i++, frames += MPU6050_DATA_SIZE) {
+		data[i].accel_x = (s16)get_unaligned_be16(&frames[0]);
+		data[i].accel_y = (s16)get_unaligned_be16(&frames[2]);
+		data[i].accel_z = (s16)get_unaligned_be16(&frames[4]);
+		data[i].temp = (s16)get_unaligned_be16(&frames[6]);
+		data[i].gyro_x = (s16)get_unaligned_be16(&frames[8]);
+		data[i].gyro_y = (s16)get_unaligned_be16(&frames[10]);
+		data[i].gyro_z = (s16)get_unaligned_be16(&frames[12]);
+	}
+}
+EXPORT_SYMBOL(bc_sensor_decode);
+
+/**
+ * bc_poll_sensor_raw_data() - poll sensor registers
+ * @data: data structure pointer
+ *
+ * Polling sensor registers and filling data structure
+ * with raw data of accelerometer, gyroscope and temperature read
+ * in a single burst, so all fields belong to the same sample.
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: 0 on successful poll, error code if otherwise.
+ */
+int bc_poll_sensor_raw_data(struct sensor_data *data)
+{
+	int ret, attempt = 0;
+	u8 buf[MPU6050_DATA_SIZE];
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	do {
+		trace_sensor_read_start(MPU6050_DATA_ADDR, MPU6050_DATA_SIZE);
+		ret = mpu6050_read(MPU6050_DATA_ADDR, buf, MPU6050_DATA_SIZE);
+		trace_sensor_read_end(MPU6050_DATA_ADDR, MPU6050_DATA_SIZE,
+				      ret);
+	} while (ret < 0 && mpu6050_recover(ret, attempt++, false));
+
+	mpu6050_put();
+	if (ret < 0) {
+		dev_err_ratelimited(mpu6050_dev,
+				    "read i2c block data error: %d\n", ret);
+		return ret;
+	}
+
+	mpu6050_healthy();
+
+	bc_sensor_decode(buf, 1, data);
+	data->seq = atomic_inc_return(&sample_seq);
+	data->timestamp = ktime_get();
+
+	return 0;
+}
+EXPORT_SYMBOL(bc_poll_sensor_raw_data);
+
+/**
+ * bc_poll_sensor_raw_value() - get sensor's register value
+ * @value: pointer to 16 bit value (being written as result of poll)
+ * @type: type of data (see enum sensor_value in header file)
+ *
+ * Getting sensor's register value. @value is left untouched on error.
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: 0 on successful poll, error code if otherwise.
+ */
+int bc_poll_sensor_raw_value(s16 *value, enum sensor_value type)
+{
+	int ret;
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	ret = mpu6050_read_word(type, false);
+	mpu6050_put();
+	if (ret < 0)
+		return ret;
+
+	*value = (s16)ret;
+
+	return 0;
+}
+EXPORT_SYMBOL(bc_poll_sensor_raw_value);
+
+/**
+ * bc_poll_sensor_temperature() - get sensor's temperature
+ * @temperature: pointer to 16 bit value of temperature
+ *
+ * Getting sensor's temperature in celsius degrees.
+ * @temperature is left untouched on error.
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: 0 on successful poll, error code if otherwise.
+ */
+int bc_poll_sensor_temperature(s16 *temperature)
+{
+	int ret;
+	s16 temp;
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	ret = mpu6050_read_word(REG_TEMP_OUT_H, false);
+	mpu6050_put();
+	if (ret < 0)
+		return ret;
+
+	temp = (s16)ret;
+	*temperature = DIV_ROUND_CLOSEST(temp + 12420, 340);
+
+	return 0;
+}
+EXPORT_SYMBOL(bc_poll_sensor_temperature);
+
+/**
+ * bc_sensor_health() - get bus error recovery state
+ * @health: structure to fill
+ *
+ * Counters are cumulative since the module load.
+ */
+void bc_sensor_health(struct sensor_health *health)
+{
+	spin_lock(&health_lock);
+	*health = mpu6050_health;
+	spin_unlock(&health_lock);
+}
+EXPORT_SYMBOL(bc_sensor_health);
+
+#pragma region /* FIFO Clock */
+
+/*
+ * FIFO frames carry no timestamps and the chip's oscillator is only
+ * accurate to a few percent, so stamping a whole batch with the read time
+ * smears it over the read interval. Instead every read is an observation
+ * of how many frames the chip has produced by the time of the FIFO_COUNT
+ * read: the period is tracked as the filtered ratio of elapsed time to
+ * produced frames between reads at least FIFO_CLK_MIN_FRAMES apart, and
+ * the timeline phase is steered so the newest frame lands, on average, half
+ * a period before the count was read. Frames get timestamps from that line,
+ * never earlier than the ones handed out before.
+ */
+
+static s64 fifo_clock_offset(s64 frames)
+{
+	s64 ns = frames * (s64)fifo_clk.period;
+
+	return ns < 0 ? -(s64)((u64)-ns >> FIFO_CLK_FRAC) : ns >> FIFO_CLK_FRAC;
+}
+
+static ktime_t fifo_clock_time(u64 k)
+{
+	return ktime_add_ns(fifo_clk.anchor_t,
+			    fifo_clock_offset(k - fifo_clk.anchor_k));
+}
+
+/* The FIFO has just been reset at @t, frame 0 comes a period later */
+static void fifo_clock_restart(ktime_t t)
+{
+	fifo_clk.consumed = 0;
+	fifo_clk.produced = 0;
+	fifo_clk.anchor_k = 0;
+	fifo_clk.anchor_t = ktime_add_ns(t, fifo_clk.period >> FIFO_CLK_FRAC);
+	fifo_clk.base_k = 0;
+	fifo_clk.base_t = 0;
+	fifo_clk.resets_seen = atomic_read(&fifo_resets);
+	fifo_clk.restarts++;
+}
+
+/* Sampling at a new rate, the old estimate means nothing */
+static void fifo_clock_start(unsigned int rate, ktime_t t)
+{
+	fifo_clk.rate = rate;
+	fifo_clk.nominal = div_u64((u64)NSEC_PER_SEC << FIFO_CLK_FRAC, rate);
+	fifo_clk.period = fifo_clk.nominal;
+	fifo_clk.restarts = 0;
+	fifo_clock_restart(t);
+}
+
+/* The FIFO held @avail frames besides the consumed ones at @t */
+static void fifo_clock_observe(ktime_t t, int avail)
+{
+	u64 k, obs, tol;
+	s64 err, half;
+
+	fifo_clk.produced = fifo_clk.consumed + avail;
+	if (!fifo_clk.produced)
+		return;
+
+	/*
+	 * Counts only resolve whole frames, the phase errors of the two
+	 * ends cancel out in the filter unless one end is the reset.
+	 */
+	k = fifo_clk.produced - fifo_clk.base_k;
+	if (!fifo_clk.base_t) {
+		fifo_clk.base_k = fifo_clk.produced;
+		fifo_clk.base_t = t;
+	} else if (k >= FIFO_CLK_MIN_FRAMES) {
+		obs = div64_u64((u64)ktime_to_ns(ktime_sub(t, fifo_clk.base_t))
+				<< FIFO_CLK_FRAC, k);
+
+		/* Stalls and a lost reset don't look like any oscillator */
+		tol = div_u64(fifo_clk.nominal, FIFO_CLK_TOLERANCE);
+		if (obs + tol >= fifo_clk.nominal &&
+		    obs <= fifo_clk.nominal + tol)
+			fifo_clk.period += ((s64)obs - (s64)fifo_clk.period) /
+					   (1 << FIFO_CLK_GAIN);
+
+		fifo_clk.base_k = fifo_clk.produced;
+		fifo_clk.base_t = t;
+	}
+
+	/* The newest frame was taken within the last period before @t */
+	k = fifo_clk.produced - 1;
+	fifo_clk.anchor_t = fifo_clock_time(k);
+	fifo_clk.anchor_k = k;
+
+	err = ktime_to_ns(ktime_sub(t, fifo_clk.anchor_t));
+	half = fifo_clk.period >> (FIFO_CLK_FRAC + 1);
+	if (err < 0 || err > 4 * half)
+		err -= half;		/* Way off, snap to the middle */
+	else
+		err = (err - half) / (1 << FIFO_CLK_GAIN);
+
+	fifo_clk.anchor_t = ktime_add_ns(fifo_clk.anchor_t, err);
+}
+
+/* Timestamp of the next frame read out */
+static ktime_t fifo_clock_stamp(void)
+{
+	ktime_t t = fifo_clock_time(fifo_clk.consumed++);
+
+	if (ktime_compare(t, fifo_clk.last) <= 0)
+		t = ktime_add_ns(fifo_clk.last, 1);
+
+	fifo_clk.last = t;
+
+	return t;
+}
+
+/**
+ * bc_sensor_fifo_clock() - get the sample clock estimate
+ * @clock: filled with the estimate, not active if the FIFO is stopped
+ *
+ * The estimate starts from the programmed rate on every
+ * bc_sensor_fifo_start() and settles after a few thousand frames.
+ */
+void bc_sensor_fifo_clock(struct sensor_clock *clock)
+{
+	mutex_lock(&fifo_lock);
+
+	memset(clock, 0, sizeof(*clock));
+	clock->active = fifo_active;
+	if (fifo_active) {
+		clock->nominal = fifo_clk.rate;
+		clock->rate = div64_u64((u64)NSEC_PER_SEC * 1000 <<
+					FIFO_CLK_FRAC, fifo_clk.period);
+		clock->drift = div64_s64(((s64)fifo_clk.nominal -
+					  (s64)fifo_clk.period) * USEC_PER_SEC,
+					 fifo_clk.period);
+		clock->frames = fifo_clk.produced;
+		clock->resets = fifo_clk.restarts - 1;
+	}
+
+	mutex_unlock(&fifo_lock);
+}
+EXPORT_SYMBOL(bc_sensor_fifo_clock);
+
+#pragma endregion
+
+/**
+ * bc_sensor_fifo_start() - start buffered sampling
+ * @rate: requested sample rate in Hz
+ *
+ * Programs the sample rate divider and the low pass filter (its bandwidth
+ * is kept below the Nyquist frequency), then resets and enables the FIFO
+ * with full accelerometer, temperature and gyroscope frames.
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: actual sample rate in Hz on success, error code if otherwise.
+ */
+int bc_sensor_fifo_start(unsigned int rate)
+{
+	int i, ret, div;
+
+	if (!rate || rate > MPU6050_GYRO_RATE)
+		return -EINVAL;
+
+	div = clamp(DIV_ROUND_CLOSEST(MPU6050_GYRO_RATE, rate) - 1, 0, 255);
+	rate = MPU6050_GYRO_RATE / (div + 1);
+
+	for (i = 0; i < ARRAY_SIZE(dlpf_bw) - 1; i++)
+		if (dlpf_bw[i].bw * 2 < rate)
+			break;
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&fifo_lock);
+
+	mpu6050_cfg.config = dlpf_bw[i].cfg;
+	mpu6050_cfg.smplrt_div = div;
+	mpu6050_cfg.fifo_en = FIFO_EN_ALL;
+
+	ret = mpu6050_write(REG_CONFIG, mpu6050_cfg.config);
+	if (!ret)
+		ret = mpu6050_write(REG_SMPLRT_DIV, mpu6050_cfg.smplrt_div);
+	if (!ret)
+		ret = mpu6050_write(REG_USER_CTRL, USER_CTRL_FIFO_RESET);
+	if (!ret) {
+		fifo_clock_start(rate, ktime_get());
+		ret = mpu6050_write(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+	}
+	if (!ret)
+		ret = mpu6050_write(REG_FIFO_EN, mpu6050_cfg.fifo_en);
+
+	/* A running FIFO keeps its reference until stopped */
+	if (!ret && !fifo_active)
+		fifo_active = true;
+	else
+		mpu6050_put();
+
+	mutex_unlock(&fifo_lock);
+
+	if (ret < 0) {
+		dev_err(mpu6050_dev, "cannot start fifo: %d\n", ret);
+		return ret;
+	}
+
+	return rate;
+}
+EXPORT_SYMBOL(bc_sensor_fifo_start);
+
+/**
+ * bc_sensor_fifo_stop() - stop buffered sampling
+ *
+ * Disables the FIFO and restores unfiltered direct register sampling.
+ * The device is allowed to enter low-power mode again.
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: 0 on success, error code if otherwise.
+ */
+int bc_sensor_fifo_stop(void)
+{
+	int ret;
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&fifo_lock);
+
+	mpu6050_cfg.config = 0;
+	mpu6050_cfg.smplrt_div = 0;
+	mpu6050_cfg.fifo_en = 0;
+
+	ret = mpu6050_write(REG_FIFO_EN, 0);
+	if (!ret)
+		ret = mpu6050_write(REG_USER_CTRL, USER_CTRL_FIFO_RESET);
+	if (!ret)
+		ret = mpu6050_write(REG_SMPLRT_DIV, 0);
+	if (!ret)
+		ret = mpu6050_write(REG_CONFIG, 0);
+
+	if (fifo_active) {
+		fifo_active = false;
+		mpu6050_put();
+	}
+
+	mutex_unlock(&fifo_lock);
+
+	mpu6050_put();
+
+	return ret;
+}
+EXPORT_SYMBOL(bc_sensor_fifo_stop);
+
+/**
+ * bc_sensor_fifo_read() - drain buffered samples
+ * @data: array of data structures to fill
+ * @max: array capacity
+ *
+ * Reads all complete frames accumulated in the FIFO (up to @max) with
+ * a single bulk transfer. On overflow the frame alignment is lost, so
+ * the FIFO is reset and -EOVERFLOW returned. Frame timestamps are
+ * reconstructed from the estimated sample clock, see bc_sensor_fifo_clock().
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: number of samples read, error code if otherwise.
+ */
+int bc_sensor_fifo_read(struct sensor_data *data, int max)
+{
+	int i, ret, count;
+	u32 seq;
+	ktime_t now;
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&fifo_lock);
+
+	ret = mpu6050_read_word(REG_FIFO_COUNT_H, true);
+	now = ktime_get();
+	if (ret < 0)
+		goto unlock;
+
+	/* Recovery has reset the FIFO behind our back */
+	if (fifo_clk.resets_seen != atomic_read(&fifo_resets))
+		fifo_clock_restart(now);
+
+	if (ret > MPU6050_FIFO_SIZE - MPU6050_DATA_SIZE) {
+		mpu6050_write(REG_USER_CTRL,
+			      USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RESET);
+		fifo_clock_restart(ktime_get());
+		ret = -EOVERFLOW;
+		goto unlock;
+	}
+
+	fifo_clock_observe(now, ret / MPU6050_DATA_SIZE);
+
+	count = min(ret / MPU6050_DATA_SIZE, max);
+	if (!count) {
+		ret = 0;
+		goto unlock;
+	}
+
+	trace_sensor_read_start(REG_FIFO_R_W, count * MPU6050_DATA_SIZE);
+	ret = mpu6050_read(REG_FIFO_R_W, fifo_buf, count * MPU6050_DATA_SIZE);
+	trace_sensor_read_end(REG_FIFO_R_W, count * MPU6050_DATA_SIZE, ret);
+	if (ret < 0) {
+		/* Frame alignment is unknown, reinit resets the FIFO */
+		mpu6050_error(ret);
+		mpu6050_reinit(true);
+		goto unlock;
+	}
+
+	bc_sensor_decode(fifo_buf, count, data);
+
+	seq = atomic_add_return(count, &sample_seq) - count;
+	for (i = 0; i < count; i++) {
+		data[i].seq = ++seq;
+		data[i].timestamp = fifo_clock_stamp();
+	}
+
+	ret = count;
+
+unlock:
+	mutex_unlock(&fifo_lock);
+
+	mpu6050_put();
+
+	if (ret < 0 && ret != -EOVERFLOW)
+		dev_err_ratelimited(mpu6050_dev,
+				    "read fifo error: %d\n", ret);
+
+	return ret;
+}
+EXPORT_SYMBOL(bc_sensor_fifo_read);
+
+/**
+ * bc_sensor_motion_arm() - arm one-shot wake-on-motion interrupt
+ * @threshold: acceleration change threshold in mg
+ * @duration: time the threshold must be exceeded for, ms
+ * @handler: called from the interrupt thread when motion is detected
+ *
+ * The interrupt is disarmed before @handler is called, so it fires once
+ * per arming. Motion detection keeps working while the device sits in
+ * low-power cycle mode.
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: 0 on success, error code if otherwise.
+ */
+int bc_sensor_motion_arm(unsigned int threshold, unsigned int duration,
+			 void (*handler)(void))
+{
+	int ret;
+	u8 status;
+
+	if (int_irq < 0)
+		return -ENODEV;
+
+	if (!handler)
+		return -EINVAL;
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&motion_lock);
+
+	mpu6050_cfg.accel_config = ACCEL_CONFIG_HPF_5HZ;
+	mpu6050_cfg.mot_thr = clamp(DIV_ROUND_UP(threshold, MPU6050_MOT_THR_MG),
+				    1U, 255U);
+	mpu6050_cfg.mot_dur = clamp(duration, 1U, 255U);
+	mpu6050_cfg.int_enable = INT_MOT;
+	WRITE_ONCE(motion_handler, handler);
+
+	ret = mpu6050_write(REG_ACCEL_CONFIG, mpu6050_cfg.accel_config);
+	if (!ret)
+		ret = mpu6050_write(REG_MOT_THR, mpu6050_cfg.mot_thr);
+	if (!ret)
+		ret = mpu6050_write(REG_MOT_DUR, mpu6050_cfg.mot_dur);
+	if (!ret) {
+		/* Drop a stale latched interrupt */
+		mpu6050_read(REG_INT_STATUS, &status, 1);
+		ret = mpu6050_write(REG_INT_ENABLE, mpu6050_cfg.int_enable);
+	}
+
+	if (ret < 0) {
+		mpu6050_cfg.int_enable = 0;
+		WRITE_ONCE(motion_handler, NULL);
+	}
+
+	mutex_unlock(&motion_lock);
+
+	mpu6050_put();
+
+	if (ret < 0)
+		dev_err(mpu6050_dev, "cannot arm motion: %d\n", ret);
+
+	return ret;
+}
+EXPORT_SYMBOL(bc_sensor_motion_arm);
+
+/**
+ * bc_sensor_motion_disarm() - disarm wake-on-motion interrupt
+ *
+ * After return the handler passed to bc_sensor_motion_arm() is neither
+ * running nor going to be called, and the accelerometer and motion
+ * detector registers are back to their unarmed values.
+ * Implementation for MPU-6050 I2C Device
+ *
+ * Return: 0 on success, error code if otherwise.
+ */
+int bc_sensor_motion_disarm(void)
+{
+	int ret;
+
+	if (int_irq < 0)
+		return 0;
+
+	ret = mpu6050_get();
+	if (ret < 0)
+		return ret;
+
+	mutex_lock(&motion_lock);
+
+	/* Back to the plain accelerometer, the high pass filter included */
+	mpu6050_cfg.int_enable = 0;
+	mpu6050_cfg.accel_config = 0;
+	mpu6050_cfg.mot_thr = 0;
+	mpu6050_cfg.mot_dur = 0;
+	WRITE_ONCE(motion_handler, NULL);
+
+	ret = mpu6050_write(REG_INT_ENABLE, mpu6050_cfg.int_enable);
+	if (!ret)
+		ret = mpu6050_write(REG_ACCEL_CONFIG, mpu6050_cfg.accel_config);
+	if (!ret)
+		ret = mpu6050_write(REG_MOT_THR, mpu6050_cfg.mot_thr);
+	if (!ret)
+		ret = mpu6050_write(REG_MOT_DUR, mpu6050_cfg.mot_dur);
+
+	mutex_unlock(&motion_lock);
+
+	mpu6050_put();
+
+	synchronize_irq(int_irq);
+
+	return ret;
+}
+EXPORT_SYMBOL(bc_sensor_motion_disarm);
+
+/* Bus is accessible in cycle mode, so the device is not woken up here */
+static irqreturn_t mpu6050_irq_thread(int irq, void *dev_id)
+{
+	int ret;
+	u8 status = 0;
+	void (*handler)(void) = NULL;
+
+	mutex_lock(&motion_lock);
+
+	ret = mpu6050_read(REG_INT_STATUS, &status, 1);
+	if (!ret && (status & INT_MOT) && mpu6050_cfg.int_enable) {
+		mpu6050_cfg.int_enable = 0;
+		mpu6050_write(REG_INT_ENABLE, 0);
+		handler = motion_handler;
+	}
+
+	mutex_unlock(&motion_lock);
+
+	/* Reading the status has deasserted the latched line */
+	if (ret < 0)
+		return IRQ_NONE;
+
+	if (handler)
+		handler();
+
+	return IRQ_HANDLED;
+}
+
+static int mpu6050_request_irq(struct device *dev)
+{
+	int ret;
+
+	if (!gpio_is_valid(int_pin)) {
+		dev_err(dev, "GPIO %d is not valid\n", int_pin);
+		return -EIO;
+	}
+
+	ret = gpio_request(int_pin, INT_IRQ_LABEL);
+	if (ret < 0)
+		return ret;
+
+	ret = gpio_direction_input(int_pin);
+	if (ret < 0)
+		goto r_gpio;
+
+	ret = gpio_to_irq(int_pin);
+	if (ret < 0)
+		goto r_gpio;
+	int_irq = ret;
+
+	ret = request_threaded_irq(int_irq, NULL, mpu6050_irq_thread,
+				   IRQF_TRIGGER_RISING | IRQF_ONESHOT,
+				   INT_IRQ_LABEL, dev);
+	if (ret < 0)
+		goto r_gpio;
+
+	dev_info(dev, "motion interrupt on GPIO pin: %d\n", int_pin);
+
+	return 0;
+
+r_gpio:
+	int_irq = -1;
+	gpio_free(int_pin);
+	return ret;
+}
+
+static void mpu6050_free_irq(struct device *dev)
+{
+	if (int_irq < 0)
+		return;
+
+	free_irq(int_irq, dev);
+	gpio_free(int_pin);
+	int_irq = -1;
+}
+
+
+/* Writes the whole configuration and puts the device into a power state */
+static int mpu6050_setup(u8 pwr1, u8 pwr2)
+{
+	int ret;
+
+	ret = mpu6050_write(REG_GYRO_CONFIG, 0);
+	if (!ret)
+		ret = mpu6050_write(REG_ACCEL_CONFIG, mpu6050_cfg.accel_config);
+	if (!ret)
+		ret = mpu6050_write(REG_CONFIG, mpu6050_cfg.config);
+	if (!ret)
+		ret = mpu6050_write(REG_SMPLRT_DIV, mpu6050_cfg.smplrt_div);
+	if (!ret && mpu6050_cfg.fifo_en) {
+		atomic_inc(&fifo_resets);
+		ret = mpu6050_write(REG_USER_CTRL, USER_CTRL_FIFO_RESET);
+		if (!ret)
+			ret = mpu6050_write(REG_USER_CTRL, USER_CTRL_FIFO_EN);
+		if (!ret)
+			ret = mpu6050_write(REG_FIFO_EN, mpu6050_cfg.fifo_en);
+	}
+	if (!ret)
+		ret = mpu6050_write(REG_MOT_THR, mpu6050_cfg.mot_thr);
+	if (!ret)
+		ret = mpu6050_write(REG_MOT_DUR, mpu6050_cfg.mot_dur);
+	if (!ret)
+		ret = mpu6050_write(REG_INT_PIN_CFG, INT_PIN_CFG_LATCH_EN);
+	if (!ret)
+		ret = mpu6050_write(REG_INT_ENABLE, mpu6050_cfg.int_enable);
+	if (!ret)
+		ret = mpu6050_write(REG_PWR_MGMT_2, pwr2);
+	if (!ret)
+		ret = mpu6050_write(REG_PWR_MGMT_1, pwr1);
+
+	return ret;
+}
+
+/* Common part of the I2C and the simulated device probe */
+static int mpu6050_attach(struct device *dev, const struct mpu6050_bus *b)
+{
+	int ret;
+	u8 whoami;
+
+	bus = b;
+
+	/* Read who_am_i register */
+	ret = mpu6050_read(REG_WHO_AM_I, &whoami, 1);
+	if (ret < 0) {
+		dev_err(dev, "%s read failed with error: %d\n", bus->name, ret);
+		return ret;
+	}
+	if (whoami != MPU6050_I2C_ADDR) {
+		dev_err(dev,
+			"wrong device found: expected 0x%X, found 0x%X\n",
+			MPU6050_I2C_ADDR, whoami);
+		return -ENODEV;
+	}
+	dev_info(dev,
+		"%s mpu6050 device found, WHO_AM_I register value = 0x%X\n",
+		bus->name, whoami);
+
+	/* Setup the device */
+	ret = mpu6050_setup(0, 0);
+	if (ret < 0) {
+		dev_err(dev, "cannot setup device: %d\n", ret);
+		return ret;
+	}
+
+	/* Motion interrupt is optional, the INT pin may be not wired */
+	if (int_pin >= 0 && !sim) {
+		ret = mpu6050_request_irq(dev);
+		if (ret < 0)
+			dev_warn(dev, "no motion interrupt: %d\n", ret);
+	}
+
+	/* Device is awake, let it drop into cycle mode when idle */
+	pm_runtime_set_active(dev);
+	pm_runtime_set_autosuspend_delay(dev, autosuspend_ms);
+	pm_runtime_use_autosuspend(dev);
+	pm_runtime_enable(dev);
+	pm_runtime_mark_last_busy(dev);
+
+	mpu6050_dev = dev;
+
+	return 0;
+}
+
+static void mpu6050_detach(struct device *dev)
+{
+	mpu6050_free_irq(dev);
+
+	pm_runtime_disable(dev);
+	pm_runtime_dont_use_autosuspend(dev);
+	pm_runtime_set_suspended(dev);
+
+	mpu6050_write(REG_PWR_MGMT_1, PWR1_SLEEP);
+
+	mpu6050_dev = NULL;
+}
+
+static int mpu6050_probe(struct i2c_client *drv_client,
+			 const struct i2c_device_id *id)
+{
+	int ret;
+
+	pr_info(MP "probing...\n");
+
+	dev_info(&drv_client->dev,
+		"i2c client address is 0x%X\n", drv_client->addr);
+
+	mpu6050_client = drv_client;
+
+	ret = mpu6050_attach(&drv_client->dev, &mpu6050_i2c_bus);
+	if (ret < 0)
+		return ret;
+
+	dev_info(&drv_client->dev, "i2c driver probed\n");
+
+	return 0;
+}
+
+static int mpu6050_remove(struct i2c_client *drv_client)
+{
+	mpu6050_detach(&drv_client->dev);
+
+	dev_info(&drv_client->dev, "i2c driver removed\n");
+	return 0;
+}
+
+static int mpu6050_sim_probe(struct platform_device *pdev)
+{
+	int ret;
+
+	mpu6050_sim_reset();
+
+	ret = mpu6050_attach(&pdev->dev, &mpu6050_sim_bus);
+	if (ret < 0)
+		return ret;
+
+	dev_info(&pdev->dev, "simulated sensor probed\n");
+
+	return 0;
+}
+
+static int mpu6050_sim_remove(struct platform_device *pdev)
+{
+	mpu6050_detach(&pdev->dev);
+
+	dev_info(&pdev->dev, "simulated sensor removed\n");
+	return 0;
+}
+
+/* Gyro and temperature sensor off, accel samples at the wake-up rate */
+static int mpu6050_runtime_suspend(struct device *dev)
+{
+	int ret;
+
+	ret = mpu6050_write(REG_PWR_MGMT_2, LP_PWR_MGMT_2);
+	if (!ret)
+		ret = mpu6050_write(REG_PWR_MGMT_1, LP_PWR_MGMT_1);
+
+	return ret;
+}
+
+/*
+ * Configuration survives cycle mode, only the power state is restored.
+ * The gyro was off and its output is garbage until it has started up, so
+ * whatever the FIFO took in the meantime is dropped.
+ */
+static int mpu6050_runtime_resume(struct device *dev)
+{
+	int ret;
+
+	ret = mpu6050_write(REG_PWR_MGMT_1, 0);
+	if (!ret)
+		ret = mpu6050_write(REG_PWR_MGMT_2, 0);
+	if (ret)
+		return ret;
+
+	msleep(MPU6050_GYRO_START_MS);
+
+	if (mpu6050_cfg.fifo_en) {
+		atomic_inc(&fifo_resets);
+		ret = mpu6050_write(REG_USER_CTRL,
+				    USER_CTRL_FIFO_EN | USER_CTRL_FIFO_RESET);
+	}
+
+	return ret;
+}
+
+static int mpu6050_suspend(struct device *dev)
+{
+	int ret;
+
+	ret = pm_runtime_force_suspend(dev);
+	if (ret < 0)
+		return ret;
+
+	return mpu6050_write(REG_PWR_MGMT_1, PWR1_SLEEP);
+}
+
+/* The supply may have been cut, so the whole configuration is restored */
+static int mpu6050_resume(struct device *dev)
+{
+	int ret;
+
+	ret = mpu6050_setup(LP_PWR_MGMT_1, LP_PWR_MGMT_2);
+	if (ret < 0)
+		return ret;
+
+	return pm_runtime_force_resume(dev);
+}
+
+static const struct dev_pm_ops mpu6050_pm_ops = {
+	SET_SYSTEM_SLEEP_PM_OPS(mpu6050_suspend, mpu6050_resume)
+	SET_RUNTIME_PM_OPS(mpu6050_runtime_suspend, mpu6050_runtime_resume,
+			   NULL)
+};
+
+static const struct i2c_device_id mpu6050_id[] = {
+	{ I2C_DEVICE_NAME, 0 },
+	{ }
+};
+MODULE_DEVICE_TABLE(i2c, mpu6050_id);
+
+static struct i2c_driver mpu6050_i2c_driver = {
+	.driver = {
+		.name = I2C_DEVICE_NAME,
+		.owner = THIS_MODULE,
+		.pm = &mpu6050_pm_ops,
+	},
+	.probe = mpu6050_probe,
+	.remove = mpu6050_remove,
+	.id_table = mpu6050_id,
+};
+
+static struct platform_driver mpu6050_sim_driver = {
+	.driver = {
+		.name = SIM_DEVICE_NAME,
+		.owner = THIS_MODULE,
+		.pm = &mpu6050_pm_ops,
+	},
+	.probe = mpu6050_sim_probe,
+	.remove = mpu6050_sim_remove,
+};
+
+static struct i2c_board_info mpu6050_i2c_device_info = {
+	I2C_BOARD_INFO(I2C_DEVICE_NAME, MPU6050_I2C_ADDR)
+};
+
+static int __init sensor_sim_init(void)
+{
+	int ret;
+
+	ret = platform_driver_register(&mpu6050_sim_driver);
+	if (ret < 0) {
+		pr_err(MP "failed to register simulator driver: %d\n", ret);
+		return ret;
+	}
+
+	sim_pdev = platform_device_register_simple(SIM_DEVICE_NAME, -1,
+						   NULL, 0);
+	if (IS_ERR(sim_pdev)) {
+		pr_err(MP "failed to create simulated device\n");
+		platform_driver_unregister(&mpu6050_sim_driver);
+		return PTR_ERR(sim_pdev);
+	}
+
+	pr_info(MP "simulated sensor created\n");
+
+	return 0;
+}
+
+static int __init sensor_mod_init(void)
+{
+	int ret;
+	struct i2c_adapter *adapter;
+
+	pr_info(MP "initialization...\n");
+
+	if (sim)
+		return sensor_sim_init();
+
+	adapter = i2c_get_adapter(I2C_BUS);
+
+	pr_info(MP "adapter = 0x%p\n", adapter);
+
+	if (!adapter) {
+		pr_err(MP "failed to get I2C adapter\n");
+		return -ENODEV;
+	}
+
+	/* Create i2c client */
+	mpu6050_client = i2c_new_client_device(adapter, &mpu6050_i2c_device_info);
+
+	pr_info(MP "client = 0x%p\n", mpu6050_client);
+
+	if (!mpu6050_client) {
+		pr_err(MP "failed to create I2C client\n");
+		i2c_put_adapter(adapter);
+		return -ENODEV;
+	}
+
+	/* Create i2c driver */
+	ret = i2c_add_driver(&mpu6050_i2c_driver);
+	if (ret != 0) {
+		pr_err(MP "failed to add new i2c driver: %d\n", ret);
+		return ret;
+	}
+
+	i2c_put_adapter(adapter);
+
+	pr_info(MP "i2c driver created\n");
+
+	return 0;
+}
+
+static void __exit sensor_mod_exit(void)
+{
+	if (sim) {
+		platform_device_unregister(sim_pdev);
+		platform_driver_unregister(&mpu6050_sim_driver);
+	} else {
+		i2c_unregister_device(mpu6050_client);
+		i2c_del_driver(&mpu6050_i2c_driver);
+	}
+	pr_info(MP "module removed\n");
+}
+
+#ifdef SENSOR_KUNIT_TEST
+#include "sensor_core_test.c"
+#endif
+
+module_init(sensor_mod_init);
+module_exit(sensor_mod_exit);
+
+MODULE_LICENSE("GPL");
+MODULE_DESCRIPTION("Linux Kernel Bootcamp Project: Sensor Module");
+MODULE_AUTHOR("Vlad Degtyarov <deesyync@gmail.com>");
+MODULE_VERSION("0.1");
@@ -0,0 +1,76 @@
+// SPDX-License-Identifier: GPL
+/*
+ * KUnit tests of the FIFO sample clock, included by sensor_core.c when
+ * built with SENSOR_KUNIT_TEST=y so the static model is reachable.
+ */
+
+#include <kunit/test.h>
+
+#define TEST_RATE	1000		/* Nominal, Hz */
+#define TEST_PPM	20000		/* Chip clock runs 2% fast */
+#define TEST_BATCH	20		/* Frames per read */
+#define TEST_READS	1000
+
+/* True period of the simulated chip, ns */
+static s64 test_period(void)
+{
+	return div_u64((u64)NSEC_PER_SEC * 1000000,
+		       (u64)TEST_RATE * (1000000 + TEST_PPM));
+}
+
+/*
+ * Feeds the model with reads of TEST_BATCH frames, as the FIFO thread
+ * does, and checks each batch is stamped one estimated period apart.
+ */
+static void fifo_clock_test_batch_steps(struct kunit *test)
+{
+	int i, j;
+	s64 period = test_period(), step, est;
+	ktime_t t0 = ms_to_ktime(1000), t, prev;
+	u64 frames = 0;
+	typeof(fifo_clk) saved;
+
+	mutex_lock(&fifo_lock);
+	saved = fifo_clk;
+	memset(&fifo_clk, 0, sizeof(fifo_clk));
+
+	fifo_clock_start(TEST_RATE, t0);
+
+	for (i = 0; i < TEST_READS; i++) {
+		frames += TEST_BATCH;
+
+		/* Read a third of a period after the newest frame */
+		t = ktime_add_ns(t0, frames * period + period / 3);
+		fifo_clock_observe(t, frames - fifo_clk.consumed);
+
+		est = fifo_clock_offset(1);
+		prev = fifo_clock_stamp();
+
+		for (j = 1; j < TEST_BATCH; j++) {
+			t = fifo_clock_stamp();
+			step = ktime_to_ns(ktime_sub(t, prev));
+			KUNIT_EXPECT_LE_MSG(test, abs(step - est), 1,
+					    "read %d frame %d", i, j);
+			prev = t;
+		}
+	}
+
+	/* The estimate has locked to the chip, not to the nominal rate */
+	est = fifo_clock_offset(1000);
+	KUNIT_EXPECT_LE(test, abs(est - 1000 * period), period);
+
+	fifo_clk = saved;
+	mutex_unlock(&fifo_lock);
+}
+
+static struct kunit_case fifo_clock_test_cases[] = {
+	KUNIT_CASE(fifo_clock_test_batch_steps),
+	{}
+};
+
+static struct kunit_suite fifo_clock_test_suite = {
+	.name = "mpu6050_fifo_clock",
+	.test_cases = fifo_clock_test_cases,
+};
+
+kunit_test_suite(fifo_clock_test_suite);
@@ -3,6 +3,8 @@
 #ifndef __SENSOR_MODULE_H__
 #define __SENSOR_MODULE_H__
 
+#include <linux/ktime.h>
+
 #include "mpu6050.h"
 
 struct sensor_data {
@@ -12,6 +14,38 @@ struct sensor_data {
 	s16 gyro_x;
 	s16 gyro_y;
 	s16 gyro_z;
+	s16 temp;		/* Raw, deg C = temp / 340 + 36.53 */
+	u32 seq;		/* Sample sequence number */
+	ktime_t timestamp;	/* CLOCK_MONOTONIC time of the burst read,
+				 * of the sampling instant for FIFO frames */
+};
+
+/* FIFO frames have the same layout as the data registers block */
+#define SENSOR_FIFO_MAX_SAMPLES	(MPU6050_FIFO_SIZE / MPU6050_DATA_SIZE)
+
+enum sensor_health_state {
+	SENSOR_OK,
+	SENSOR_RECOVERING,		/* Last transfer needed a retry */
+	SENSOR_FAILED,			/* Recovery didn't help */
+};
+
+struct sensor_health {
+	enum sensor_health_state state;
+	u32 errors;			/* Failed transfers */
+	u32 retries;
+	u32 reinits;			/* Chip re-initializations */
+	u32 failures;			/* Operations failed after recovery */
+	int last_error;
+};
+
+/* Sensor sample clock as seen from CLOCK_MONOTONIC while the FIFO runs */
+struct sensor_clock {
+	bool active;
+	unsigned int nominal;		/* Programmed sample rate, Hz */
+	u32 rate;			/* Estimated sample rate, mHz */
+	s32 drift;			/* Estimate against nominal, ppm */
+	u64 frames;			/* Frames produced since the FIFO reset */
+	u32 resets;			/* Timeline restarts */
 };
 
 enum sensor_value {
@@ -26,5 +60,17 @@ enum sensor_value {
 extern int bc_poll_sensor_raw_data(struct sensor_data *data);
 extern int bc_poll_sensor_raw_value(s16 *value, enum sensor_value type);
 extern int bc_poll_sensor_temperature(s16 *temperature);
+extern void bc_sensor_health(struct sensor_health *health);
+extern void bc_sensor_decode(const u8 *frames, int count,
+			     struct sensor_data *data);
+
+extern int bc_sensor_fifo_start(unsigned int rate);
+extern int bc_sensor_fifo_stop(void);
+extern int bc_sensor_fifo_read(struct sensor_data *data, int max);
+extern void bc_sensor_fifo_clock(struct sensor_clock *clock);
+
+extern int bc_sensor_motion_arm(unsigned int threshold, unsigned int duration,
+				void (*handler)(void));
+extern int bc_sensor_motion_disarm(void);
 
 #endif /* __SENSOR_MODULE_H__ */
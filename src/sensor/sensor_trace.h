@@ -0,0 +1,59 @@
+/* SPDX-License-Identifier: GPL */
+
+#undef TRACE_SYSTEM
+#define TRACE_SYSTEM bc_sensor
+
+#if !defined(__SENSOR_TRACE_H__) || defined(TRACE_HEADER_MULTI_READ)
+#define __SENSOR_TRACE_H__
+
+#include <linux/tracepoint.h>
+
+TRACE_EVENT(sensor_read_start,
+
+	TP_PROTO(u8 reg, int len),
+
+	TP_ARGS(reg, len),
+
+	TP_STRUCT__entry(
+		__field(u8, reg)
+		__field(int, len)
+	),
+
+	TP_fast_assign(
+		__entry->reg = reg;
+		__entry->len = len;
+	),
+
+	TP_printk("reg=0x%02x len=%d", __entry->reg, __entry->len)
+);
+
+TRACE_EVENT(sensor_read_end,
+
+	TP_PROTO(u8 reg, int len, int ret),
+
+	TP_ARGS(reg, len, ret),
+
+	TP_STRUCT__entry(
+		__field(u8, reg)
+		__field(int, len)
+		__field(int, ret)
+	),
+
+	TP_fast_assign(
+		__entry->reg = reg;
+		__entry->len = len;
+		__entry->ret = ret;
+	),
+
+	TP_printk("reg=0x%02x len=%d ret=%d",
+		  __entry->reg, __entry->len, __entry->ret)
+);
+
+#endif /* __SENSOR_TRACE_H__ */
+
+/* This part must be outside protection */
+#undef TRACE_INCLUDE_PATH
+#define TRACE_INCLUDE_PATH .
+#undef TRACE_INCLUDE_FILE
+#define TRACE_INCLUDE_FILE sensor_trace
+#include <trace/define_trace.h>
@@ -0,0 +1,53 @@
+#!/bin/bash
+
+# Checks that a steady reading keeps the panel on while the unit is active.
+# Runs on the simulated sensor and the emulated panel, from the directory
+# with the built modules. The sensor is left noiseless and still, so the
+# inclinometer redraws nothing after the first frame.
+
+BUS_MOD=bus_module
+SENSOR_MOD=sensor_module
+DISPLAY_MOD=display_module
+LOGIC_MOD=inclinometer
+
+AUTOSUSPEND_MS=200		# Panel blanking timeout
+WAIT_S=3			# Many timeouts, far below idle_timeout
+
+TRACE_DIR=/sys/kernel/tracing
+EMU_STATS=/sys/kernel/debug/ssd1306/stats
+
+
+# Removing loaded modules, users first
+for MOD in $LOGIC_MOD $DISPLAY_MOD $SENSOR_MOD $BUS_MOD; do
+	if lsmod | grep -wq "$MOD"; then
+		sudo rmmod $MOD
+	fi
+done
+
+sudo insmod ${BUS_MOD}.ko
+sudo insmod ${SENSOR_MOD}.ko sim=1 sim_noise=0 sim_gyro_drift=0
+sudo insmod ${DISPLAY_MOD}.ko emu=1 autosuspend_ms=${AUTOSUSPEND_MS}
+
+echo 0 | sudo tee ${TRACE_DIR}/tracing_on > /dev/null
+echo | sudo tee ${TRACE_DIR}/trace > /dev/null
+echo 1 | sudo tee ${TRACE_DIR}/events/bc_display/display_power/enable > /dev/null
+echo 1 | sudo tee ${TRACE_DIR}/tracing_on > /dev/null
+
+sudo insmod ${LOGIC_MOD}.ko idle_timeout=60
+
+sleep ${WAIT_S}
+
+echo 0 | sudo tee ${TRACE_DIR}/tracing_on > /dev/null
+echo 0 | sudo tee ${TRACE_DIR}/events/bc_display/display_power/enable > /dev/null
+
+offs=$(sudo grep -c "display_power: on=0" ${TRACE_DIR}/trace)
+panel=$(sudo head -n 1 ${EMU_STATS})
+
+echo "panel blanked ${offs} times, emulator: ${panel}"
+
+if [ "${offs}" -ne 0 ] || ! echo "${panel}" | grep -q "panel on"; then
+	echo "FAIL: steady reading blanked the panel"
+	exit 1
+fi
+
+echo "PASS"
@@ -5,6 +5,7 @@
 # ACCEL_CALIBRATION="-850,920,900"
 # GYRO_CALIBRATION="567,1,183"
 
+BUS_MOD=bus_module
 SENSOR_MOD=sensor_module
 DISPLAY_MOD=display_module
 LOGIC_MOD=inclinometer
@@ -13,21 +14,20 @@ LOGIC_MOD=inclinometer
 # Inserting modules
 # Keeping the right order
 
-# Removing Logic module if loaded
-if lsmod | grep -wq "$LOGIC_MOD"; then
-	sudo rmmod $LOGIC_MOD
-fi
+# Removing loaded modules, users first
+for MOD in $LOGIC_MOD $DISPLAY_MOD $SENSOR_MOD $BUS_MOD; do
+	if lsmod | grep -wq "$MOD"; then
+		sudo rmmod $MOD
+	fi
+done
+
+# Shared Bus Module, both drivers depend on it
+sudo insmod ${BUS_MOD}.ko
 
 # Sensor Module
-if lsmod | grep -wq "$SENSOR_MOD"; then
-	sudo rmmod $SENSOR_MOD
-fi
 sudo insmod ${SENSOR_MOD}.ko
 
 # Display Module
-if lsmod | grep -wq "$DISPLAY_MOD"; then
-	sudo rmmod $DISPLAY_MOD
-fi
 sudo insmod ${DISPLAY_MOD}.ko
 
 # Business Logic Module
@@ -42,6 +42,6 @@ sudo insmod ${LOGIC_MOD}.ko \
 	${GYRO_CALIB_PARAM}
 )
 
-lsmod | head -n 4
+lsmod | head -n 5
 echo
 dmesg --color=always | tail -n 24
@@ -1,5 +1,6 @@
 #!/bin/bash
 
+BUS_MOD=bus_module
 SENSOR_MOD=sensor_module
 DISPLAY_MOD=display_module
 LOGIC_MOD=inclinometer
@@ -11,3 +12,4 @@ sudo rmmod ${LOGIC_MOD}
 
 sudo rmmod ${DISPLAY_MOD}
 sudo rmmod ${SENSOR_MOD}
+sudo rmmod ${BUS_MOD}